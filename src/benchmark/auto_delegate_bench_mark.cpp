@@ -1,8 +1,20 @@
 #include <benchmark/benchmark.h>
 #include <random>
+#include <algorithm>
 #include <functional>
+#include <array>
+#include <span>
+#include <tuple>
+#include <optional>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <deque>
 
 #include "../reference_safe_delegate/reference_safe_delegate.h"
+#include "../delegate/function_ref.h"
+#include "../delegate/concurrent_multicast_function.h"
+#include "../delegate/queued_multicast.h"
 
 
 using namespace auto_delegate;
@@ -498,6 +510,239 @@ static void BM_FunctionV2(benchmark::State& state)
     }
 }
 
+template<size_t>
+static void BM_FunctionRef(benchmark::State& state)
+{
+    std::vector<function_ref<int(ARG_LIST)>> funcs;
+    funcs.reserve(object_count);
+
+    ForEachObject([&]<size_t I>(auto&& o, index_tag<I>)
+                  {
+                      funcs.emplace_back(o, func_tag<&B<I>::function>{});
+                  });
+
+    for (auto _: state)
+    {
+        for (auto& f: funcs)
+        {
+            f(INVOKE_PARAMS);
+        }
+    }
+}
+
+#if defined _MSC_VER
+#define BENCH_NOINLINE __declspec(noinline)
+#else
+#define BENCH_NOINLINE __attribute__((noinline))
+#endif
+
+//synchronous callback parameter, the callee never stores the callable
+BENCH_NOINLINE static void CallbackByFunction(function<void(ARG_LIST)> f)
+{
+    f(INVOKE_PARAMS);
+}
+
+BENCH_NOINLINE static void CallbackByFunctionRef(function_ref<void(ARG_LIST)> f)
+{
+    f(INVOKE_PARAMS);
+}
+
+static void BM_FunctionParam(benchmark::State& state)
+{
+    std::vector<function<void(ARG_LIST)>> funcs;
+    funcs.reserve(object_count);
+
+    ForEachObject([&]<size_t I>(auto&& o, index_tag<I>)
+                  {
+                      funcs.emplace_back([o](ARG_LIST)
+                                         {
+                                             o->function(ARG_LIST_FORWARD);
+                                         });
+                  });
+
+    for (auto _: state)
+    {
+        for (auto& f: funcs)
+        {
+            CallbackByFunction(f);
+        }
+    }
+}
+
+static void BM_FunctionRefParam(benchmark::State& state)
+{
+    std::vector<function<void(ARG_LIST)>> funcs;
+    funcs.reserve(object_count);
+
+    ForEachObject([&]<size_t I>(auto&& o, index_tag<I>)
+                  {
+                      funcs.emplace_back([o](ARG_LIST)
+                                         {
+                                             o->function(ARG_LIST_FORWARD);
+                                         });
+                  });
+
+    for (auto _: state)
+    {
+        for (auto& f: funcs)
+        {
+            CallbackByFunctionRef(f);
+        }
+    }
+}
+
+//capture with a non trivial move, relocated by memcpy only when opted in
+template<bool Relocatable>
+static auto MakeSharedCapture(auto o, const std::shared_ptr<int>& s)
+{
+    auto f = [o, s](ARG_LIST)
+    {
+        o->function(ARG_LIST_FORWARD);
+    };
+    if constexpr (Relocatable) return make_trivially_relocatable(f);
+    else return f;
+}
+
+template<bool Relocatable>
+static void BM_FunctionGrowth(benchmark::State& state)
+{
+    auto s = std::make_shared<int>(0);
+    std::vector<function<void(ARG_LIST)>> prototype;
+    prototype.reserve(object_count);
+    ForEachObject([&]<size_t I>(auto&& o, index_tag<I>)
+                  {
+                      prototype.emplace_back(MakeSharedCapture<Relocatable>(o, s));
+                  });
+
+    for (auto _: state)
+    {
+        //relocate every element on each reallocation
+        std::vector<function<void(ARG_LIST)>> funcs;
+        for (auto& f: prototype)
+            funcs.emplace_back(std::move(f));
+        benchmark::DoNotOptimize(funcs.data());
+        for (auto& f: funcs)
+            prototype[&f - funcs.data()] = std::move(f);
+    }
+}
+
+template<bool Relocatable>
+static void BM_FunctionChurn(benchmark::State& state)
+{
+    auto s = std::make_shared<int>(0);
+    std::vector<function<void(ARG_LIST)>> funcs;
+    funcs.reserve(object_count);
+    ForEachObject([&]<size_t I>(auto&& o, index_tag<I>)
+                  {
+                      funcs.emplace_back(MakeSharedCapture<Relocatable>(o, s));
+                  });
+
+    size_t index = 0;
+    for (auto _: state)
+    {
+        //swap back removal as multicast_function::object_container::remove, then bind again
+        for (size_t i = 0; i < object_count; ++i)
+        {
+            index = (index + 7) % funcs.size();
+            function<void(ARG_LIST)> removed = std::move(funcs[index]);
+            funcs[index] = std::move(funcs.back());
+            funcs.pop_back();
+            funcs.emplace_back(std::move(removed));
+        }
+        benchmark::DoNotOptimize(funcs.data());
+    }
+}
+
+//capture larger than the small buffer, boxed by deep copy or shared by reference count
+template<bool Shared>
+static void BM_FunctionCopy(benchmark::State& state)
+{
+    std::array<int, 32> table{};
+    std::vector<function<void(ARG_LIST)>> funcs;
+    funcs.reserve(object_count);
+    ForEachObject([&]<size_t I>(auto&& o, index_tag<I>)
+                  {
+                      auto f = [o, table](ARG_LIST)
+                      {
+                          benchmark::DoNotOptimize(table.data());
+                          o->function(ARG_LIST_FORWARD);
+                      };
+                      if constexpr (Shared) funcs.emplace_back(shared_box, f);
+                      else funcs.emplace_back(f);
+                  });
+
+    for (auto _: state)
+    {
+        //snapshot the listener set
+        std::vector<function<void(ARG_LIST)>> snapshot = funcs;
+        benchmark::DoNotOptimize(snapshot.data());
+    }
+}
+
+struct ExpectedHandler
+{
+    B<0>* o;
+
+    void operator()(ARG_LIST) const
+    {
+        o->function(ARG_LIST_FORWARD);
+    }
+};
+
+//the expected handler type is checked by invoker and called directly
+template<bool InvokeAs>
+static void BM_FunctionInvokeAs(benchmark::State& state)
+{
+    std::vector<B<0>> objects(object_count);
+    std::vector<function<void(ARG_LIST)>> funcs;
+    funcs.reserve(object_count);
+    for (auto& o: objects)
+        funcs.emplace_back(ExpectedHandler{&o});
+
+    for (auto _: state)
+    {
+        for (auto& f: funcs)
+        {
+            if constexpr (InvokeAs) f.invoke_as<ExpectedHandler>(INVOKE_PARAMS);
+            else f(INVOKE_PARAMS);
+        }
+    }
+}
+
+template<typename T>
+struct ValidatedCallable
+{
+    T* o;
+
+    bool validate(function_v2::function_validate_tag) const { return o != nullptr; }
+
+    void operator()(ARG_LIST) const
+    {
+        o->function(ARG_LIST_FORWARD);
+    }
+};
+
+template<size_t>
+static void BM_FunctionV2Validated(benchmark::State& state)
+{
+    static constexpr size_t SOB = sizeof(std::function<void(ARG_LIST)>) - 16;
+    std::vector<function_v2::function<void(ARG_LIST), SOB>> funcs;
+    funcs.reserve(object_count);
+
+    ForEachObject([&]<size_t I>(auto&& o, index_tag<I>)
+                  {
+                      funcs.emplace_back(ValidatedCallable<B<I>>{o});
+                  });
+
+    for (auto _: state)
+    {
+        for (auto& f: funcs)
+        {
+            f(INVOKE_PARAMS);
+        }
+    }
+}
+
 BENCHMARK(BM_StdFunction<0>)BENCHMARK_ARGS;
 BENCHMARK(BM_StdFunction<1>)BENCHMARK_ARGS;
 BENCHMARK(BM_StdFunction<2>)BENCHMARK_ARGS;
@@ -514,6 +759,28 @@ BENCHMARK(BM_FunctionV2<1>)BENCHMARK_ARGS;
 BENCHMARK(BM_FunctionV2<2>)BENCHMARK_ARGS;
 BENCHMARK(BM_FunctionV2<3>)BENCHMARK_ARGS;
 
+BENCHMARK(BM_FunctionV2Validated<0>)BENCHMARK_ARGS;
+BENCHMARK(BM_FunctionV2Validated<1>)BENCHMARK_ARGS;
+BENCHMARK(BM_FunctionV2Validated<2>)BENCHMARK_ARGS;
+BENCHMARK(BM_FunctionV2Validated<3>)BENCHMARK_ARGS;
+
+BENCHMARK(BM_FunctionRef<0>)BENCHMARK_ARGS;
+BENCHMARK(BM_FunctionRef<1>)BENCHMARK_ARGS;
+BENCHMARK(BM_FunctionRef<2>)BENCHMARK_ARGS;
+BENCHMARK(BM_FunctionRef<3>)BENCHMARK_ARGS;
+
+BENCHMARK(BM_FunctionParam)BENCHMARK_ARGS;
+BENCHMARK(BM_FunctionRefParam)BENCHMARK_ARGS;
+
+BENCHMARK(BM_FunctionGrowth<false>)BENCHMARK_ARGS;
+BENCHMARK(BM_FunctionGrowth<true>)BENCHMARK_ARGS;
+BENCHMARK(BM_FunctionChurn<false>)BENCHMARK_ARGS;
+BENCHMARK(BM_FunctionChurn<true>)BENCHMARK_ARGS;
+BENCHMARK(BM_FunctionCopy<false>)BENCHMARK_ARGS;
+BENCHMARK(BM_FunctionCopy<true>)BENCHMARK_ARGS;
+BENCHMARK(BM_FunctionInvokeAs<false>)BENCHMARK_ARGS;
+BENCHMARK(BM_FunctionInvokeAs<true>)BENCHMARK_ARGS;
+
 
 
 
@@ -579,6 +846,729 @@ static void BM_MulticastFunc_InvokeAction(benchmark::State& state)
 //BENCHMARK(BM_MulticastFunc_InvokeAction)BENCHMARK_ARGS;
 
 
+//the same listeners dispatched through a plain and a noexcept signature
+template<typename Signature>
+static void BM_MulticastFunc_InvokeSignature(benchmark::State& state)
+{
+    TestTemplate<multicast_function<Signature>>(
+            state,
+            [](auto&& d, auto&& ptr)
+            {
+                using T = std::pointer_traits<std::decay_t<decltype(ptr)>>::element_type;
+                d.template bind<&T::action>(ptr);
+            },
+            [](auto&& d)
+            {
+                d.invoke(INVOKE_PARAMS);
+            }
+    );
+}
+
+BENCHMARK(BM_MulticastFunc_InvokeSignature<void(ARG_LIST)>)BENCHMARK_ARGS;
+BENCHMARK(BM_MulticastFunc_InvokeSignature<void(ARG_LIST) noexcept>)BENCHMARK_ARGS;
+
+template<typename Signature>
+static void BM_DefaultMulticast_InvokeSignature(benchmark::State& state)
+{
+    TestTemplate<multicast_delegate<Signature>>(
+            state,
+            [](auto&& d, auto&& ptr)
+            {
+                using T = std::pointer_traits<std::decay_t<decltype(ptr)>>::element_type;
+                return d.template bind<&T::action>(ptr);
+            },
+            [](auto&& d)
+            {
+                d.invoke(INVOKE_PARAMS);
+            }
+    );
+}
+
+BENCHMARK(BM_DefaultMulticast_InvokeSignature<void(ARG_LIST)>)BENCHMARK_ARGS;
+BENCHMARK(BM_DefaultMulticast_InvokeSignature<void(ARG_LIST) noexcept>)BENCHMARK_ARGS;
+
+static void NoOpListener(ARG_LIST) noexcept {}
+
+//a listener binds more listeners on every call, they are queued and removed after the invoke
+template<size_t BindCount>
+static void BM_MulticastFunc_BindInsideInvoke(benchmark::State& state)
+{
+    using event_t = multicast_function<void(ARG_LIST)>;
+    using handle_t = decltype(std::declval<event_t&>().bind_unique_handled<NoOpListener>());
+    event_t event;
+    std::vector<handle_t> handles;
+    handles.reserve(BindCount);
+    ForEachObject([&]<size_t I>(auto&& o, index_tag<I>)
+                  {
+                      event.bind<&B<I>::action>(o);
+                  });
+    event.bind([&](ARG_LIST)
+               {
+                   for (size_t i = 0; i < BindCount; ++i)
+                       handles.emplace_back(event.bind_unique_handled<NoOpListener>());
+               });
+
+    for (auto _: state)
+    {
+        event.invoke(INVOKE_PARAMS);
+        handles.clear();
+    }
+}
+
+BENCHMARK(BM_MulticastFunc_BindInsideInvoke<1>)BENCHMARK_ARGS;
+BENCHMARK(BM_MulticastFunc_BindInsideInvoke<16>)BENCHMARK_ARGS;
+
+//tasks are claimed from a shared counter, so idle workers take over the chunks of busy ones
+class ParallelPool
+{
+    std::vector<std::jthread> workers;
+    std::atomic<uint64_t> generation{0};
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> idle_workers{0};
+    size_t task_count = 0;
+    const function_ref<void(size_t)>* task = nullptr;
+    bool stop = false;
+
+    void run()
+    {
+        for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < task_count;)
+            (*task)(i);
+    }
+
+public:
+    explicit ParallelPool(size_t thread_count)
+    {
+        for (size_t t = 1; t < thread_count; ++t)
+            workers.emplace_back([this]
+                                 {
+                                     uint64_t seen = 0;
+                                     while (true)
+                                     {
+                                         generation.wait(seen, std::memory_order_acquire);
+                                         seen = generation.load(std::memory_order_acquire);
+                                         if (stop) return;
+                                         run();
+                                         idle_workers.fetch_add(1, std::memory_order_release);
+                                     }
+                                 });
+    }
+
+    ~ParallelPool()
+    {
+        stop = true;
+        generation.fetch_add(1, std::memory_order_release);
+        generation.notify_all();
+    }
+
+    void bulk_execute(size_t count, function_ref<void(size_t)> t)
+    {
+        task = &t;
+        task_count = count;
+        next.store(0, std::memory_order_relaxed);
+        idle_workers.store(0, std::memory_order_relaxed);
+        generation.fetch_add(1, std::memory_order_release);
+        generation.notify_all();
+        run();
+        //every worker has left run before the next job resets the counter
+        while (idle_workers.load(std::memory_order_acquire) < workers.size())
+            std::this_thread::yield();
+    }
+};
+
+static constexpr size_t parallel_listener_count = 1 << 14;
+
+struct HashListener
+{
+    uint64_t state;
+
+    void operator()(ARG_LIST)
+    {
+        for (int i = 0; i < 32; ++i)
+            state = state * 6364136223846793005ull + 1442695040888963407ull;
+        benchmark::DoNotOptimize(state);
+    }
+};
+
+//range(0) is the number of threads, 0 is the serial invoke
+static void BM_MulticastFunc_ParallelInvoke(benchmark::State& state)
+{
+    multicast_function<void(ARG_LIST)> event;
+    for (size_t i = 0; i < parallel_listener_count; ++i)
+        event.bind(HashListener{i});
+    ParallelPool pool(std::max<int64_t>(state.range(0), 1));
+
+    for (auto _: state)
+    {
+        if (state.range(0) == 0) event.invoke(INVOKE_PARAMS);
+        else event.parallel_invoke(pool, parallel_grain{256}, INVOKE_PARAMS);
+    }
+    state.SetItemsProcessed(state.iterations() * parallel_listener_count);
+}
+
+BENCHMARK(BM_MulticastFunc_ParallelInvoke)->Arg(0)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
+
+static void BM_DefaultMulticast_ParallelInvoke(benchmark::State& state)
+{
+    std::vector<HashListener> listeners(parallel_listener_count);
+    multicast_delegate<void(ARG_LIST)> event;
+    std::vector<multicast_delegate<void(ARG_LIST)>::delegate_handle_t> handles;
+    handles.reserve(parallel_listener_count);
+    for (auto& l: listeners)
+        handles.emplace_back(event.bind<&HashListener::operator()>(&l));
+    ParallelPool pool(std::max<int64_t>(state.range(0), 1));
+
+    for (auto _: state)
+    {
+        if (state.range(0) == 0) event.invoke(INVOKE_PARAMS);
+        else event.parallel_invoke(pool, parallel_grain{256}, INVOKE_PARAMS);
+    }
+    state.SetItemsProcessed(state.iterations() * parallel_listener_count);
+}
+
+BENCHMARK(BM_DefaultMulticast_ParallelInvoke)->Arg(0)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
+
+static constexpr size_t grouped_listener_count = 1024;
+
+//binds grouped_listener_count B<I> listeners over range(0) classes in random order, range(1) sorts them by invoker
+template<typename Event>
+static void InvokerGroupTemplate(benchmark::State& state, auto&& bind)
+{
+    const size_t classes = std::min<size_t>(state.range(0), class_count);
+    std::vector<size_t> order(grouped_listener_count);
+    for (size_t i = 0; i < grouped_listener_count; ++i) order[i] = i % classes;
+    std::shuffle(order.begin(), order.end(), std::mt19937(42));
+
+    Event event;
+    std::vector<std::shared_ptr<void>> objects;
+    for (size_t c: order)
+    {
+        [&]<size_t...I>(std::index_sequence<I...>)
+        {
+            auto bind_class = [&]<size_t Index>(index_tag<Index>)
+            {
+                auto o = std::make_shared<B<Index>>();
+                bind(event, o.get());
+                objects.push_back(std::move(o));
+            };
+            ((c == I ? bind_class(index_tag<I>{}) : void()), ...);
+        }(std::make_index_sequence<class_count>{});
+    }
+    if constexpr (requires { event.sort_by_invoker(); })
+        if (state.range(1)) event.sort_by_invoker();
+
+    for (auto _: state)
+        event.invoke(INVOKE_PARAMS);
+    state.SetItemsProcessed(state.iterations() * grouped_listener_count);
+}
+
+static void BM_DefaultMulticast_InvokerGroup(benchmark::State& state)
+{
+    using event_t = multicast_delegate<void(ARG_LIST)>;
+    std::vector<event_t::delegate_handle_t> handles;
+    handles.reserve(grouped_listener_count);
+    InvokerGroupTemplate<event_t>(state, [&](event_t& event, auto* o)
+    {
+        using T = std::remove_pointer_t<decltype(o)>;
+        handles.emplace_back(event.bind<&T::action>(o));
+    });
+}
+
+BENCHMARK(BM_DefaultMulticast_InvokerGroup)->ArgsProduct({{1, 8, 32, 128}, {0, 1}});
+
+static void BM_MulticastFunc_InvokerGroup(benchmark::State& state)
+{
+    using event_t = multicast_function<void(ARG_LIST)>;
+    InvokerGroupTemplate<event_t>(state, [&](event_t& event, auto* o)
+    {
+        event.bind([o](ARG_LIST) noexcept { o->action(t1, t2, t1c, t2c); });
+    });
+}
+
+BENCHMARK(BM_MulticastFunc_InvokerGroup)->ArgsProduct({{1, 8, 32, 128}, {0, 1}});
+
+//listeners bucketed by invoker at bind, already grouped so range(1) is always 0
+static void BM_GroupedMulticast_InvokerGroup(benchmark::State& state)
+{
+    using event_t = multicast_grouped_delegate<void(ARG_LIST)>;
+    std::vector<event_t::delegate_handle_t> handles;
+    handles.reserve(grouped_listener_count);
+    InvokerGroupTemplate<event_t>(state, [&](event_t& event, auto* o)
+    {
+        using T = std::remove_pointer_t<decltype(o)>;
+        handles.emplace_back(event.bind<&T::action>(o));
+    });
+}
+
+BENCHMARK(BM_GroupedMulticast_InvokerGroup)->ArgsProduct({{1, 8, 32, 128}, {0}});
+
+static constexpr size_t churn_listener_count = 256;
+
+struct ChurnListener
+{
+    uint64_t* sum = nullptr;
+
+    void on_event(ARG_LIST) noexcept { *sum += t1.value; }
+
+    void operator()(ARG_LIST) noexcept { *sum += t1.value; }
+};
+
+//range(0) listeners are unbound and bound again before every invoke
+template<typename Event>
+static void BM_Multicast_Churn(benchmark::State& state)
+{
+    uint64_t sum = 0;
+    std::vector<ChurnListener> listeners(churn_listener_count, ChurnListener{&sum});
+    Event event;
+    auto bind = [&](size_t i)
+    {
+        if constexpr (requires { event.bind_unique_handled(ChurnListener{}); })
+            return event.bind_unique_handled(ChurnListener{listeners[i]});
+        else
+            return event.template bind<&ChurnListener::on_event>(&listeners[i]);
+    };
+    std::vector<std::optional<decltype(bind(0))>> handles;
+    handles.reserve(churn_listener_count);
+    for (size_t i = 0; i < churn_listener_count; ++i) handles.emplace_back(bind(i));
+    std::mt19937 eng(42);
+
+    for (auto _: state)
+    {
+        for (int64_t c = 0; c < state.range(0); ++c)
+        {
+            size_t i = eng() % churn_listener_count;
+            handles[i].reset();
+            handles[i].emplace(bind(i));
+        }
+        event.invoke(INVOKE_PARAMS);
+    }
+    benchmark::DoNotOptimize(sum);
+    state.SetItemsProcessed(state.iterations() * churn_listener_count);
+}
+
+BENCHMARK(BM_Multicast_Churn<multicast_delegate<void(ARG_LIST)>>)->Arg(0)->Arg(1)->Arg(16)->Arg(64);
+BENCHMARK(BM_Multicast_Churn<multicast_ordered_delegate<void(ARG_LIST)>>)->Arg(0)->Arg(1)->Arg(16)->Arg(64);
+BENCHMARK(BM_Multicast_Churn<multicast_function<void(ARG_LIST)>>)->Arg(0)->Arg(1)->Arg(16)->Arg(64);
+BENCHMARK(BM_Multicast_Churn<multicast_ordered_function<void(ARG_LIST)>>)->Arg(0)->Arg(1)->Arg(16)->Arg(64);
+BENCHMARK(BM_Multicast_Churn<multicast_slot_map_delegate<void(ARG_LIST)>>)->Arg(0)->Arg(1)->Arg(16)->Arg(64);
+
+//range(0) listeners bound one by one into an empty event then unbound in random order, storage grows without reserve
+template<typename Event>
+static void BM_Multicast_HandleGrowth(benchmark::State& state)
+{
+    uint64_t sum = 0;
+    std::vector<ChurnListener> listeners(state.range(0), ChurnListener{&sum});
+    using handle_t = typename Event::delegate_handle_t;
+    std::vector<size_t> order(state.range(0));
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::shuffle(order.begin(), order.end(), std::mt19937(42));
+
+    for (auto _: state)
+    {
+        Event event;
+        std::vector<std::optional<handle_t>> handles;
+        handles.reserve(listeners.size());
+        for (auto& l: listeners) handles.emplace_back(event.template bind<&ChurnListener::on_event>(&l));
+        for (size_t i: order) handles[i].reset();
+        benchmark::DoNotOptimize(event.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_Multicast_HandleGrowth<multicast_delegate<void(ARG_LIST)>>)->Arg(64)->Arg(1024)->Arg(16384);
+BENCHMARK(BM_Multicast_HandleGrowth<multicast_slot_map_delegate<void(ARG_LIST)>>)->Arg(64)->Arg(1024)->Arg(16384);
+BENCHMARK(BM_Multicast_HandleGrowth<multicast_ordered_delegate<void(ARG_LIST)>>)->Arg(64)->Arg(1024)->Arg(16384);
+BENCHMARK(BM_Multicast_HandleGrowth<multicast_delegate<void(ARG_LIST), slot_map_delegate_container<ordered_removal<>>>>)->Arg(64)->Arg(1024)->Arg(16384);
+
+//range(0) listeners bound by handle, the invoke walks every one of them
+template<typename Event>
+static void BM_Multicast_Layout(benchmark::State& state)
+{
+    uint64_t sum = 0;
+    std::vector<ChurnListener> listeners(state.range(0), ChurnListener{&sum});
+    Event event;
+    std::vector<typename Event::delegate_handle_t> handles;
+    handles.reserve(listeners.size());
+    for (auto& l: listeners) handles.push_back(event.template bind<&ChurnListener::on_event>(&l));
+
+    for (auto _: state)
+        event.invoke(INVOKE_PARAMS);
+    benchmark::DoNotOptimize(sum);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_Multicast_Layout<multicast_delegate<void(ARG_LIST)>>)->Arg(1024)->Arg(16384)->Arg(262144);
+BENCHMARK(BM_Multicast_Layout<multicast_soa_delegate<void(ARG_LIST)>>)->Arg(1024)->Arg(16384)->Arg(262144);
+
+struct ScatteredListener : public generic_ref_reflector
+{
+    uint64_t value = 0;
+
+    void action(ARG_LIST) noexcept { value += t1.value; }
+};
+
+//every listener in its own allocation followed by a random padding, handed out in shuffled order
+//the objects of consecutive listeners share no cache line and no page, so each call starts cold
+struct ScatteredObjects
+{
+    std::vector<void*> raw_mem;
+    std::vector<ScatteredListener*> objects;
+
+    explicit ScatteredObjects(size_t count)
+    {
+        std::mt19937 eng(42);
+        constexpr size_t align = alignof(ScatteredListener);
+        raw_mem.reserve(count);
+        objects.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            size_t mem_size = sizeof(ScatteredListener) + std::uniform_int_distribution<size_t>(64, 4096)(eng);
+            mem_size = (mem_size + align - 1) / align * align;
+#ifdef _MSC_VER
+            void* mem = _aligned_malloc(mem_size, align);
+#else
+            void* mem = std::aligned_alloc(align, mem_size);
+#endif
+            if (!mem) throw std::bad_alloc();
+            raw_mem.push_back(mem);
+            objects.push_back(new(mem) ScatteredListener());
+        }
+        std::shuffle(objects.begin(), objects.end(), eng);
+    }
+
+    ~ScatteredObjects()
+    {
+        for (auto o: objects) o->~ScatteredListener();
+        for (auto ptr: raw_mem)
+        {
+#ifdef _MSC_VER
+            _aligned_free(ptr);
+#else
+            std::free(ptr);
+#endif
+        }
+    }
+};
+
+//range(0) scattered listeners, range(1) the prefetch distance, 0 is the plain invoke
+template<typename Event>
+static void BM_Multicast_PrefetchInvoke(benchmark::State& state)
+{
+    ScatteredObjects scattered(state.range(0));
+    Event event;
+    std::vector<typename Event::delegate_handle_t> handles;
+    handles.reserve(scattered.objects.size());
+    for (auto o: scattered.objects) handles.push_back(event.template bind<&ScatteredListener::action>(o));
+    const prefetch_distance distance{size_t(state.range(1))};
+
+    for (auto _: state)
+    {
+        if (distance.listeners == 0) event.invoke(INVOKE_PARAMS);
+        else event.prefetch_invoke(distance, INVOKE_PARAMS);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_Multicast_PrefetchInvoke<multicast_delegate<void(ARG_LIST)>>)->ArgsProduct({{4096, 65536}, {0, 4, 8, 16}});
+BENCHMARK(BM_Multicast_PrefetchInvoke<multicast_auto_delegate<void(ARG_LIST)>>)->ArgsProduct({{4096, 65536}, {0, 4, 8, 16}});
+
+//range(0) listeners bound as member function pointers, 8 bytes of state each
+template<typename Event>
+static void BM_MulticastFunc_Storage(benchmark::State& state)
+{
+    std::vector<ChurnListener> listeners(state.range(0));
+    uint64_t sum = 0;
+    Event event;
+    for (auto& l: listeners)
+    {
+        l.sum = &sum;
+        event.template bind<&ChurnListener::on_event>(&l);
+    }
+
+    for (auto _: state)
+        event.invoke(INVOKE_PARAMS);
+    benchmark::DoNotOptimize(sum);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["bytes_per_listener"] = double(event.memory_size()) / state.range(0);
+}
+
+BENCHMARK(BM_MulticastFunc_Storage<multicast_function<void(ARG_LIST)>>)->Arg(64)->Arg(1024)->Arg(16384);
+BENCHMARK(BM_MulticastFunc_Storage<multicast_packed_function<void(ARG_LIST)>>)->Arg(64)->Arg(1024)->Arg(16384);
+
+static constexpr size_t concurrent_listener_count = 64;
+
+struct ReadListener
+{
+    uint64_t salt = 0;
+
+    void operator()(ARG_LIST) noexcept { benchmark::DoNotOptimize(t1.value + salt); }
+};
+
+//multicast_function behind a mutex taken by the invoking and the rebinding threads
+struct MutexGuardedEvent
+{
+    using handle_t = decltype(std::declval<multicast_function<void(ARG_LIST)>&>().bind_unique_handled(ReadListener{}));
+
+    std::mutex mutex;
+    multicast_function<void(ARG_LIST)> event;
+    std::deque<handle_t> handles;
+
+    void bind(uint64_t salt)
+    {
+        std::lock_guard lock(mutex);
+        handles.push_back(event.bind_unique_handled(ReadListener{salt}));
+    }
+
+    void unbind_oldest()
+    {
+        std::lock_guard lock(mutex);
+        handles.pop_front();
+    }
+
+    void invoke()
+    {
+        std::lock_guard lock(mutex);
+        event.invoke(INVOKE_PARAMS);
+    }
+};
+
+struct ConcurrentEvent
+{
+    concurrent_multicast_function<void(ARG_LIST)> event;
+    std::deque<concurrent_multicast_function<void(ARG_LIST)>::listener_id> ids;
+
+    void bind(uint64_t salt) { ids.push_back(event.bind(ReadListener{salt})); }
+
+    void unbind_oldest()
+    {
+        event.unbind(ids.front());
+        ids.pop_front();
+    }
+
+    void invoke() { event.invoke(INVOKE_PARAMS); }
+};
+
+//thread 0 replaces the oldest listener every iteration, the other threads invoke
+template<typename Event>
+static void BM_Multicast_ConcurrentInvoke(benchmark::State& state)
+{
+    static Event* event;
+    if (state.thread_index() == 0)
+    {
+        event = new Event;
+        for (size_t i = 0; i < concurrent_listener_count; ++i) event->bind(i);
+    }
+    uint64_t salt = concurrent_listener_count;
+
+    for (auto _: state)
+    {
+        if (state.thread_index() == 0)
+        {
+            event->unbind_oldest();
+            event->bind(salt++);
+        } else
+            event->invoke();
+    }
+    if (state.thread_index() == 0) delete event;
+    else state.SetItemsProcessed(state.iterations() * concurrent_listener_count);
+}
+
+BENCHMARK(BM_Multicast_ConcurrentInvoke<MutexGuardedEvent>)->Threads(2)->Threads(4)->Threads(8)->UseRealTime();
+BENCHMARK(BM_Multicast_ConcurrentInvoke<ConcurrentEvent>)->Threads(2)->Threads(4)->Threads(8)->UseRealTime();
+
+static constexpr size_t posted_listener_count = 16;
+
+struct PostedListener
+{
+    uint64_t sum = 0;
+
+    void action(ARG_LIST) noexcept { sum += t1.value + t2c.value; }
+};
+
+struct AffineListener : PostedListener, mailbox_affinity
+{
+    explicit AffineListener(mailbox& box) : mailbox_affinity(box) {}
+};
+
+//listeners bound with bind_posted, invoke pushes one mail per listener to the lock free mailbox
+struct MailboxPostedEvent
+{
+    mailbox box;
+    std::deque<AffineListener> listeners;
+    multicast_delegate<void(ARG_LIST)> event;
+    std::vector<multicast_delegate<void(ARG_LIST)>::delegate_handle_t> handles;
+
+    MailboxPostedEvent()
+    {
+        for (size_t i = 0; i < posted_listener_count; ++i)
+        {
+            listeners.emplace_back(box);
+            handles.push_back(event.bind_posted<&AffineListener::action>(&listeners.back()));
+        }
+    }
+
+    void invoke() { event.invoke(INVOKE_PARAMS); }
+
+    void drain() { box.drain(); }
+};
+
+//one std::function per listener call pushed under a mutex, the owner swaps the queue out and runs it
+struct MutexQueuedEvent
+{
+    std::mutex mutex;
+    std::vector<std::function<void()>> queue;
+    std::vector<std::function<void()>> draining;
+    std::vector<PostedListener> listeners{posted_listener_count};
+
+    void invoke()
+    {
+        for (auto& l: listeners)
+        {
+            std::lock_guard lock(mutex);
+            queue.emplace_back([&l, t1 = PARAMS.v1, t2 = PARAMS.v2, t1c = PARAMS.v1, t2c = PARAMS.v2]() mutable
+                               {
+                                   l.action(t1, t2, t1c, t2c);
+                               });
+        }
+    }
+
+    void drain()
+    {
+        {
+            std::lock_guard lock(mutex);
+            std::swap(queue, draining);
+        }
+        for (auto& f: draining) f();
+        draining.clear();
+    }
+};
+
+//thread 0 owns the listeners and drains every iteration, the other threads invoke
+template<typename Event>
+static void BM_Multicast_CrossThreadPost(benchmark::State& state)
+{
+    static Event* event;
+    if (state.thread_index() == 0) event = new Event;
+
+    for (auto _: state)
+    {
+        if (state.thread_index() == 0) event->drain();
+        else event->invoke();
+    }
+    if (state.thread_index() == 0)
+    {
+        event->drain();
+        delete event;
+    } else state.SetItemsProcessed(state.iterations() * posted_listener_count);
+}
+
+BENCHMARK(BM_Multicast_CrossThreadPost<MutexQueuedEvent>)->Threads(2)->Threads(4)->Threads(8)->UseRealTime();
+BENCHMARK(BM_Multicast_CrossThreadPost<MailboxPostedEvent>)->Threads(2)->Threads(4)->Threads(8)->UseRealTime();
+
+static constexpr size_t batch_listener_count = 128;
+static constexpr size_t batch_event_count = 256;
+
+struct AccumulateListener
+{
+    uint64_t state;
+
+    void operator()(uint64_t v) { state = state * 31 + v; }
+};
+
+//same work, the batch is handed over in one call
+struct BatchAccumulateListener : AccumulateListener
+{
+    void invoke_batch(std::span<const std::tuple<uint64_t>> batch)
+    {
+        for (auto& [v]: batch) state = state * 31 + v;
+    }
+};
+
+//one invoke per event against one invoke_batch per frame
+template<bool Batch, typename Listener>
+static void BM_MulticastFunc_InvokeBatch(benchmark::State& state)
+{
+    multicast_function<void(uint64_t)> event;
+    for (size_t i = 0; i < batch_listener_count; ++i)
+        event.bind(Listener{i});
+    std::vector<std::tuple<uint64_t>> events(batch_event_count);
+    for (size_t i = 0; i < batch_event_count; ++i) events[i] = {i * 7};
+
+    for (auto _: state)
+    {
+        if constexpr (Batch) event.invoke_batch(events);
+        else for (auto& [v]: events) event.invoke(v);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * batch_listener_count * batch_event_count);
+}
+
+BENCHMARK(BM_MulticastFunc_InvokeBatch<false, AccumulateListener>);
+BENCHMARK(BM_MulticastFunc_InvokeBatch<true, AccumulateListener>);
+BENCHMARK(BM_MulticastFunc_InvokeBatch<true, BatchAccumulateListener>);
+
+//range(0) 0 invokes every event as it is raised, 1 enqueues them and flushes once, 2 flushes listener major
+static void BM_MulticastFunc_Queued(benchmark::State& state)
+{
+    queued_multicast_function<void(uint64_t)> event;
+    for (size_t i = 0; i < batch_listener_count; ++i)
+        event.bind(BatchAccumulateListener{i});
+    event.reserve(batch_event_count);
+
+    for (auto _: state)
+    {
+        for (size_t i = 0; i < batch_event_count; ++i)
+        {
+            if (state.range(0) == 0) event.invoke(i * 7);
+            else event.enqueue(i * 7);
+        }
+        if (state.range(0) == 1) event.flush();
+        else if (state.range(0) == 2) event.flush_batch();
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * batch_listener_count * batch_event_count);
+}
+
+BENCHMARK(BM_MulticastFunc_Queued)->Arg(0)->Arg(1)->Arg(2);
+
+static constexpr size_t combine_listener_count = 1024;
+
+//range(0) 0 folds through for_each_invoke, 1 through combiners::sum
+static void BM_MulticastFunc_CombineSum(benchmark::State& state)
+{
+    multicast_function<int(int)> event;
+    for (size_t i = 0; i < combine_listener_count; ++i)
+        event.bind([i](int v) { return int(i) ^ v; });
+
+    for (auto _: state)
+    {
+        int sum = 0;
+        if (state.range(0) == 0) event.for_each_invoke(3, [&](int r) { sum += r; });
+        else sum = event.combine(combiners::sum{}, 3);
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * combine_listener_count);
+}
+
+BENCHMARK(BM_MulticastFunc_CombineSum)->Arg(0)->Arg(1);
+
+//the answer is known at the first listener, range(0) 0 still walks every listener
+static void BM_MulticastFunc_CombineAnyOf(benchmark::State& state)
+{
+    multicast_function<bool(int)> event;
+    for (size_t i = 0; i < combine_listener_count; ++i)
+        event.bind([i](int v) { return int(i) == v; });
+
+    for (auto _: state)
+    {
+        bool any = false;
+        if (state.range(0) == 0) event.for_each_invoke(0, [&](bool r) { any = any || r; });
+        else any = event.combine(combiners::any_of{}, 0);
+        benchmark::DoNotOptimize(any);
+    }
+}
+
+BENCHMARK(BM_MulticastFunc_CombineAnyOf)->Arg(0)->Arg(1);
+
 static void BM_MulticastFunc_InvokeFunction(benchmark::State& state)
 {
     TestTemplate<multicast_function<int(ARG_LIST)>>(
@@ -792,7 +1782,7 @@ static void BM_WeakMulticast_InvokeAction(benchmark::State& state)
     );
 }
 
-//BENCHMARK(BM_WeakMulticast_InvokeAction)BENCHMARK_ARGS;
+BENCHMARK(BM_WeakMulticast_InvokeAction)BENCHMARK_ARGS;
 
 
 static void BM_WeakMulticast_InvokeFunction(benchmark::State& state)
@@ -813,7 +1803,77 @@ static void BM_WeakMulticast_InvokeFunction(benchmark::State& state)
     );
 }
 
-//BENCHMARK(BM_WeakMulticast_InvokeFunction)BENCHMARK_ARGS;
+BENCHMARK(BM_WeakMulticast_InvokeFunction)BENCHMARK_ARGS;
+
+static void BM_WeakMulticastFunc_InvokeAction(benchmark::State& state)
+{
+    TestTemplate<multicast_function<void(ARG_LIST)>, StdSharedObjectArray>(
+            state,
+            [](auto&& d, auto&& ptr)
+            {
+                using T = std::pointer_traits<std::decay_t<decltype(ptr)>>::element_type;
+                d.template bind_weak<&T::action>(ptr);
+            },
+            [](auto&& d)
+            {
+                d.invoke(INVOKE_PARAMS);
+            }
+    );
+}
+
+BENCHMARK(BM_WeakMulticastFunc_InvokeAction)BENCHMARK_ARGS;
+
+static void BM_WeakMulticastFunc_InvokeFunction(benchmark::State& state)
+{
+    TestTemplate<multicast_function<int(ARG_LIST)>, StdSharedObjectArray>(
+            state,
+            [](auto&& d, auto&& ptr)
+            {
+                using T = std::pointer_traits<std::decay_t<decltype(ptr)>>::element_type;
+                d += weak_binder(ptr) | bind_memfn<&T::function>;
+            },
+            [](auto&& d)
+            {
+                d.for_each_invoke(INVOKE_PARAMS, [](auto&& res)
+                {
+                });
+            }
+    );
+}
+
+BENCHMARK(BM_WeakMulticastFunc_InvokeFunction)BENCHMARK_ARGS;
+
+static constexpr size_t expiring_listener_count = 1024;
+
+//range(0) owners are replaced before every invoke, range(1) sweeps the expired listeners instead of removing them on call
+static void BM_WeakMulticastFunc_Expire(benchmark::State& state)
+{
+    uint64_t sum = 0;
+    std::vector<std::shared_ptr<ChurnListener>> owners;
+    multicast_function<void(ARG_LIST)> event;
+    for (size_t i = 0; i < expiring_listener_count; ++i)
+    {
+        owners.push_back(std::make_shared<ChurnListener>(&sum));
+        event.bind_weak<&ChurnListener::on_event>(owners.back());
+    }
+    std::mt19937 eng(42);
+
+    for (auto _: state)
+    {
+        for (int64_t c = 0; c < state.range(0); ++c)
+        {
+            auto& owner = owners[eng() % expiring_listener_count];
+            owner = std::make_shared<ChurnListener>(&sum);
+            event.bind_weak<&ChurnListener::on_event>(owner);
+        }
+        if (state.range(1)) event.remove_expired();
+        event.invoke(INVOKE_PARAMS);
+    }
+    benchmark::DoNotOptimize(sum);
+    state.SetItemsProcessed(state.iterations() * expiring_listener_count);
+}
+
+BENCHMARK(BM_WeakMulticastFunc_Expire)->ArgsProduct({{0, 16, 256}, {0, 1}});
 
 //
 //static void BM_WeakMulticast_InvokeVirtualAction(benchmark::State& state)
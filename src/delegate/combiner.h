@@ -0,0 +1,239 @@
+#pragma once
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <type_traits>
+
+//combiners fold the results of a non void multicast invoke into a single value
+//an accumulator returning false from push stops the invoke, the remaining listeners are not called
+namespace auto_delegate::combiners
+{
+    //the first result that converts to true, a value initialized Ret when there is none
+    struct first_valid
+    {
+        template<typename Ret>
+        struct accumulator
+        {
+            Ret value{};
+
+            explicit accumulator(const first_valid&) {}
+
+            bool push(Ret&& ret)
+            {
+                if (!static_cast<bool>(ret)) return true;
+                value = std::move(ret);
+                return false;
+            }
+
+            Ret result() { return std::move(value); }
+        };
+    };
+
+    //true once a result satisfies pred, false for no listener
+    template<typename Pred = std::identity>
+    struct any_of
+    {
+        Pred pred{};
+
+        template<typename Ret>
+        struct accumulator
+        {
+            const any_of& self;
+            bool value = false;
+
+            explicit accumulator(const any_of& self) : self(self) {}
+
+            bool push(Ret&& ret) { return !(value = static_cast<bool>(std::invoke(self.pred, ret))); }
+
+            bool result() const { return value; }
+        };
+    };
+
+    //false once a result fails pred, true for no listener
+    template<typename Pred = std::identity>
+    struct all_of
+    {
+        Pred pred{};
+
+        template<typename Ret>
+        struct accumulator
+        {
+            const all_of& self;
+            bool value = true;
+
+            explicit accumulator(const all_of& self) : self(self) {}
+
+            bool push(Ret&& ret) { return value = static_cast<bool>(std::invoke(self.pred, ret)); }
+
+            bool result() const { return value; }
+        };
+    };
+
+    template<typename Pred>
+    any_of(Pred) -> any_of<Pred>;
+
+    template<typename Pred>
+    all_of(Pred) -> all_of<Pred>;
+
+    //smallest result, nullopt for no listener
+    struct min
+    {
+        template<typename Ret>
+        struct accumulator
+        {
+            std::optional<Ret> value;
+
+            explicit accumulator(const min&) {}
+
+            bool push(Ret&& ret)
+            {
+                if (!value || ret < *value) value = std::move(ret);
+                return true;
+            }
+
+            void push_block(std::span<const Ret> block)
+            {
+                Ret m = block[0];
+                for (auto& r: block) m = r < m ? r : m;
+                if (!value || m < *value) value = m;
+            }
+
+            std::optional<Ret> result() { return std::move(value); }
+        };
+    };
+
+    //largest result, nullopt for no listener
+    struct max
+    {
+        template<typename Ret>
+        struct accumulator
+        {
+            std::optional<Ret> value;
+
+            explicit accumulator(const max&) {}
+
+            bool push(Ret&& ret)
+            {
+                if (!value || *value < ret) value = std::move(ret);
+                return true;
+            }
+
+            void push_block(std::span<const Ret> block)
+            {
+                Ret m = block[0];
+                for (auto& r: block) m = m < r ? r : m;
+                if (!value || *value < m) value = m;
+            }
+
+            std::optional<Ret> result() { return std::move(value); }
+        };
+    };
+
+    //sum of the results from a value initialized Ret
+    struct sum
+    {
+        template<typename Ret>
+        struct accumulator
+        {
+            Ret value{};
+
+            explicit accumulator(const sum&) {}
+
+            bool push(Ret&& ret)
+            {
+                value = std::move(value) + std::move(ret);
+                return true;
+            }
+
+            //may reassociate, floating point sums can differ from the listener order
+            void push_block(std::span<const Ret> block) { value = std::reduce(block.begin(), block.end(), value); }
+
+            Ret result() { return std::move(value); }
+        };
+    };
+
+    //writes results in listener order and stops once out is full, returns the written part of out
+    template<typename T>
+    struct collect_into
+    {
+        std::span<T> out;
+
+        collect_into(std::span<T> out) : out(out) {}
+
+        template<typename Ret>
+        struct accumulator
+        {
+            std::span<T> out;
+            size_t count = 0;
+
+            explicit accumulator(const collect_into& self) : out(self.out) {}
+
+            bool push(Ret&& ret)
+            {
+                if (count == out.size()) return false;
+                out[count++] = std::move(ret);
+                return count != out.size();
+            }
+
+            std::span<T> result() const { return out.first(count); }
+        };
+    };
+
+    template<typename Range>
+    collect_into(Range&&) -> collect_into<std::remove_reference_t<decltype(*std::data(std::declval<Range&>()))>>;
+}
+
+namespace auto_delegate
+{
+    template<typename Combiner, typename Ret>
+    concept result_combiner = std::constructible_from<typename Combiner::template accumulator<Ret>, const Combiner&>
+                              and requires(typename Combiner::template accumulator<Ret> accumulator, Ret&& ret)
+    {
+        { accumulator.push(std::move(ret)) } -> std::convertible_to<bool>;
+        accumulator.result();
+    };
+
+    namespace details
+    {
+        //results buffered before a block reduction
+        inline constexpr size_t combine_block_size = 64;
+
+        template<typename Accumulator, typename Ret>
+        concept block_accumulator = std::is_arithmetic_v<Ret> and requires(Accumulator& accumulator, std::span<const Ret> block)
+        {
+            accumulator.push_block(block);
+        };
+
+        //invoke_each(push) calls push(Ret&&) for every result until push returns false
+        template<typename Ret, typename Combiner, typename InvokeEach>
+        auto combine(const Combiner& combiner, InvokeEach&& invoke_each)
+        {
+            using accumulator_t = typename Combiner::template accumulator<Ret>;
+            accumulator_t accumulator(combiner);
+            if constexpr (block_accumulator<accumulator_t, Ret>)
+            {
+                //arithmetic results are reduced from a contiguous buffer
+                std::array<Ret, combine_block_size> block;
+                size_t count = 0;
+                invoke_each([&](Ret&& ret)
+                            {
+                                block[count++] = ret;
+                                if (count == block.size())
+                                {
+                                    accumulator.push_block(std::span<const Ret>(block.data(), count));
+                                    count = 0;
+                                }
+                                return true;
+                            });
+                if (count) accumulator.push_block(std::span<const Ret>(block.data(), count));
+            } else
+                invoke_each([&](Ret&& ret) { return static_cast<bool>(accumulator.push(std::move(ret))); });
+            return accumulator.result();
+        }
+    }
+}
@@ -0,0 +1,271 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <span>
+#include <utility>
+#include <vector>
+#include "function.h"
+#include "combiner.h"
+#include "parallel_invoke.h"
+
+namespace auto_delegate
+{
+    namespace details
+    {
+        //epoch based reclamation shared by every concurrent_multicast_function
+        //a reader publishes the epoch it entered at, memory retired at an epoch is freed once every reader has left it
+        class epoch_domain
+        {
+        public:
+            static constexpr uint64_t idle = std::numeric_limits<uint64_t>::max();
+
+            struct alignas(cache_line_size) slot
+            {
+                std::atomic<uint64_t> epoch{idle};
+                std::atomic<bool> in_use{true};
+                slot* next = nullptr;
+                //nested invokes on the owning thread keep the outermost epoch
+                uint32_t nesting = 0;
+            };
+
+            //registers the calling thread for the duration of a read
+            class guard
+            {
+                slot& s;
+            public:
+                explicit guard(slot& s) : s(s)
+                {
+                    if (s.nesting++ == 0) s.epoch.store(instance().global.load());
+                }
+
+                guard(const guard&) = delete;
+
+                ~guard()
+                {
+                    if (--s.nesting == 0) s.epoch.store(idle, std::memory_order_release);
+                }
+            };
+
+            static epoch_domain& instance()
+            {
+                static epoch_domain domain;
+                return domain;
+            }
+
+            //the slot of the calling thread, registered on its first read and released when it exits
+            static slot& thread_slot()
+            {
+                thread_local struct owner
+                {
+                    slot* s = instance().acquire_slot();
+
+                    ~owner() { s->in_use.store(false, std::memory_order_release); }
+                } owner;
+                return *owner.s;
+            }
+
+            //called after a new snapshot is published, returns the epoch the replaced memory is retired at
+            uint64_t advance() { return global.fetch_add(1); }
+
+            //memory retired at an epoch below it can not be seen by any reader
+            uint64_t safe_epoch() const
+            {
+                uint64_t min = idle;
+                for (slot* s = slots.load(std::memory_order_acquire); s; s = s->next)
+                    min = std::min(min, s->epoch.load());
+                return min;
+            }
+
+            ~epoch_domain()
+            {
+                for (slot* s = slots.load(); s;)
+                    delete std::exchange(s, s->next);
+            }
+
+        private:
+            std::atomic<uint64_t> global{0};
+            std::atomic<slot*> slots{nullptr};
+
+            epoch_domain() = default;
+
+            //reuses the slot of an exited thread, slots are never unlinked
+            slot* acquire_slot()
+            {
+                for (slot* s = slots.load(std::memory_order_acquire); s; s = s->next)
+                {
+                    bool free = false;
+                    if (!s->in_use.load(std::memory_order_relaxed) and s->in_use.compare_exchange_strong(free, true))
+                        return s;
+                }
+                auto* s = new slot;
+                s->next = slots.load(std::memory_order_relaxed);
+                while (!slots.compare_exchange_weak(s->next, s, std::memory_order_release, std::memory_order_relaxed));
+                return s;
+            }
+        };
+    }
+
+    template<typename Func, typename Function = function<Func>>
+    class concurrent_multicast_function;
+
+    //invoke reads an immutable snapshot of the listeners without locking
+    //bind and unbind copy the snapshot under a writer lock and publish the copy, replaced snapshots are reclaimed by epochs
+    template<typename Ret, typename... Args, bool NoExcept, typename Function> requires (not std::is_rvalue_reference_v<Args> && ...)
+    class concurrent_multicast_function<Ret(Args...) noexcept(NoExcept), Function>
+    {
+    public:
+        using function_t = Function;
+        using listener_id = uint64_t;
+
+    private:
+        struct node
+        {
+            listener_id id;
+            function_t callee;
+        };
+
+        struct snapshot
+        {
+            std::vector<node*> nodes;
+        };
+
+        struct retired
+        {
+            uint64_t epoch;
+            snapshot* replaced;
+            node* removed;
+        };
+
+        std::atomic<snapshot*> current;
+        std::mutex writer;
+        std::vector<retired> retired_list;
+        listener_id next_id = 1;
+
+        using domain_t = details::epoch_domain;
+
+        //writer lock held, the replaced snapshot and the removed nodes are retired after the exchange
+        void publish(snapshot* next, std::span<node* const> removed)
+        {
+            snapshot* replaced = current.exchange(next);
+            const uint64_t epoch = domain_t::instance().advance();
+            retired_list.push_back({epoch, replaced, nullptr});
+            for (node* n: removed)
+                retired_list.push_back({epoch, nullptr, n});
+            reclaim();
+        }
+
+        //writer lock held
+        void reclaim()
+        {
+            const uint64_t safe = domain_t::instance().safe_epoch();
+            std::erase_if(retired_list, [safe](const retired& r)
+            {
+                if (r.epoch >= safe) return false;
+                delete r.replaced;
+                delete r.removed;
+                return true;
+            });
+        }
+
+    public:
+        concurrent_multicast_function() : current(new snapshot) {}
+
+        concurrent_multicast_function(const concurrent_multicast_function&) = delete;
+
+        //no invoke may run concurrently with the destruction
+        ~concurrent_multicast_function()
+        {
+            snapshot* last = current.load();
+            for (node* n: last->nodes) delete n;
+            delete last;
+            for (auto& r: retired_list)
+            {
+                delete r.replaced;
+                delete r.removed;
+            }
+        }
+
+        template<typename Callable>
+        requires std::same_as<std::invoke_result_t<Callable, Args...>, Ret>
+                 and std::constructible_from<function_t, Callable>
+        listener_id bind(Callable&& callable)
+        {
+            auto* n = new node{0, function_t(std::forward<Callable>(callable))};
+            std::lock_guard lock(writer);
+            n->id = next_id++;
+            auto* next = new snapshot(*current.load(std::memory_order_relaxed));
+            next->nodes.push_back(n);
+            publish(next, {});
+            return n->id;
+        }
+
+        //returns false when the listener is already unbound
+        bool unbind(listener_id id)
+        {
+            std::lock_guard lock(writer);
+            snapshot* last = current.load(std::memory_order_relaxed);
+            auto it = std::find_if(last->nodes.begin(), last->nodes.end(), [id](node* n) { return n->id == id; });
+            if (it == last->nodes.end()) return false;
+            auto* next = new snapshot;
+            next->nodes.reserve(last->nodes.size() - 1);
+            next->nodes.insert(next->nodes.end(), last->nodes.begin(), it);
+            next->nodes.insert(next->nodes.end(), it + 1, last->nodes.end());
+            publish(next, std::span(it, 1));
+            return true;
+        }
+
+        void clear()
+        {
+            std::lock_guard lock(writer);
+            snapshot* last = current.load(std::memory_order_relaxed);
+            publish(new snapshot, last->nodes);
+        }
+
+        size_t size()
+        {
+            domain_t::guard guard(domain_t::thread_slot());
+            return current.load()->nodes.size();
+        }
+
+        bool empty() { return size() == 0; }
+
+        //listeners bound or unbound meanwhile are seen by the next invoke
+        void invoke(Args... args) noexcept(NoExcept) requires std::same_as<Ret, void>
+        {
+            domain_t::guard guard(domain_t::thread_slot());
+            for (node* n: current.load()->nodes)
+                n->callee(args...);
+        }
+
+        void operator()(Args... args) noexcept(NoExcept) requires std::same_as<Ret, void>
+        {
+            invoke(args...);
+        }
+
+        template<typename Callable>
+        requires (!std::same_as<Ret, void>)
+        void for_each_invoke(Args... args, Callable&& result_proc)
+        {
+            domain_t::guard guard(domain_t::thread_slot());
+            for (node* n: current.load()->nodes)
+                result_proc(n->callee(args...));
+        }
+
+        //folds the results through a combiner from auto_delegate::combiners, stops early once it has its answer
+        template<typename Combiner>
+        requires (!std::same_as<Ret, void>) and result_combiner<std::decay_t<Combiner>, Ret>
+        auto combine(Combiner&& combiner, Args... args)
+        {
+            domain_t::guard guard(domain_t::thread_slot());
+            return details::combine<Ret>(combiner, [&](auto&& push)
+            {
+                for (node* n: current.load()->nodes)
+                    if (!push(n->callee(args...))) break;
+            });
+        }
+    };
+}
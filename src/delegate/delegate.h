@@ -16,37 +16,39 @@ namespace auto_delegate
     delegate(T_ptr, T_MemFunc) ->
     delegate<typename details::function_traits<T_MemFunc>::function_type, void*>;
 
-    template<typename Ret, typename... Args, typename GenericPtr>
-    class delegate<Ret(Args...), GenericPtr>
+    template<typename Ret, typename... Args, bool NoExcept, typename GenericPtr>
+    class delegate<Ret(Args...) noexcept(NoExcept), GenericPtr>
     {
         template<typename, typename>
         friend class multicast_delegate;
+        template<typename>
+        friend class function_ref;
 
         template<typename T, auto MemFunc>
-        static Ret Invoker(void* obj, Args... args)
+        static Ret Invoker(void* obj, Args... args) noexcept(NoExcept)
         {
             return (reinterpret_cast<T*>(obj)->*MemFunc)(std::forward<Args>(args)...);
         }
 
         template<typename T, auto Lambda>
-        static Ret LambdaInvoker(void* obj, Args... args)
+        static Ret LambdaInvoker(void* obj, Args... args) noexcept(NoExcept)
         {
             return Lambda(*(T*) obj, std::forward<Args>(args)...);
         }
 
         template<auto Callable>
-        static Ret StaticInvoker(void*, Args... args)
+        static Ret StaticInvoker(void*, Args... args) noexcept(NoExcept)
         {
             return Callable(std::forward<Args>(args)...);
         }
 
         template<auto Lambda>
-        static Ret StaticLambdaInvoker(void*, Args... args)
+        static Ret StaticLambdaInvoker(void*, Args... args) noexcept(NoExcept)
         {
             return Lambda(std::forward<Args>(args)...);
         }
 
-        using invoker_t = Ret (*)(void*, Args...);
+        using invoker_t = Ret (*)(void*, Args...) noexcept(NoExcept);
 
         GenericPtr ptr;
         invoker_t invoker;
@@ -57,18 +59,33 @@ namespace auto_delegate
         template<typename T_ptr>
         using value_of = typename std::pointer_traits<T_ptr>::element_type;
     public:
-        using function_type = Ret(Args...);
-        using function_pointer = Ret(*)(Args...);
+        using function_type = Ret(Args...) noexcept(NoExcept);
+        using function_pointer = Ret(*)(Args...) noexcept(NoExcept);
 
-        delegate() : ptr(), invoker() {}
+        constexpr delegate() : ptr(), invoker() {}
 
         //bind methods
         template<auto MemFunc, typename T_ptr>
-        delegate(const T_ptr& obj, func_tag<MemFunc>) : ptr(obj), invoker(Invoker<value_of<T_ptr>, MemFunc>) {}
+        requires details::nothrow_invocable_if<NoExcept, decltype(MemFunc), value_of<T_ptr>&, Args...>
+        constexpr delegate(const T_ptr& obj, func_tag<MemFunc>) : ptr(obj), invoker(Invoker<value_of<T_ptr>, MemFunc>) {}
+
+        //bind static function, constant initializable
+        template<auto StaticFunc>
+        requires std::same_as<std::invoke_result_t<decltype(StaticFunc), Args...>, Ret>
+                 && details::nothrow_invocable_if<NoExcept, decltype(StaticFunc), Args...>
+        constexpr delegate(func_tag<StaticFunc>) : ptr(), invoker(StaticInvoker<StaticFunc>) {}
+
+        //bind a stateless callable object, constant initializable
+        template<typename Callable>
+        requires std::same_as<std::invoke_result_t<std::decay_t<Callable>, Args...>, Ret>
+                 && std::is_empty_v<std::decay_t<Callable>>
+                 && details::nothrow_invocable_if<NoExcept, std::decay_t<Callable>, Args...>
+        constexpr delegate(Callable&&) : ptr(), invoker(StaticLambdaInvoker<std::decay_t<Callable>{}>) {}
 
         //bind methods
         template<auto MemFunc, typename T_ptr>
-        void bind(const T_ptr& obj, func_tag<MemFunc> = {})
+        requires details::nothrow_invocable_if<NoExcept, decltype(MemFunc), value_of<T_ptr>&, Args...>
+        constexpr void bind(const T_ptr& obj, func_tag<MemFunc> = {})
         {
             ptr = obj;
             invoker = Invoker<value_of<T_ptr>, MemFunc>;
@@ -77,7 +94,8 @@ namespace auto_delegate
         //bind object with lambda
         template<typename T_ptr, typename Callable>
         requires std::is_empty_v<Callable> && requires { LambdaInvoker<value_of<T_ptr>, std::decay_t<Callable>{}>; }
-        void bind(const T_ptr& obj, Callable&& func)
+                 && details::nothrow_invocable_if<NoExcept, std::decay_t<Callable>, value_of<T_ptr>&, Args...>
+        constexpr void bind(const T_ptr& obj, Callable&& func)
         {
             ptr = obj;
             invoker = LambdaInvoker<value_of<T_ptr>, std::decay_t<Callable>{}>;
@@ -85,10 +103,11 @@ namespace auto_delegate
 
         //bind callable object
         template<typename T_ptr>
-        void bind(const T_ptr& callable)
+        constexpr void bind(const T_ptr& callable)
         requires std::same_as<
                 std::invoke_result_t<std::decay_t<decltype(*callable)>, Args...>,
                 Ret>
+                 && details::nothrow_invocable_if<NoExcept, std::decay_t<decltype(*callable)>&, Args...>
         {
             ptr = callable;
             invoker = Invoker<value_of<T_ptr>, &std::decay_t<decltype(*callable)>::operator()>;
@@ -96,7 +115,7 @@ namespace auto_delegate
 
         //bind static function
         template<function_pointer StaticFunc>
-        void bind()
+        constexpr void bind()
         {
             if constexpr (requires { ptr = nullptr; })
                 ptr = nullptr;
@@ -107,21 +126,23 @@ namespace auto_delegate
 
         //bind a stateless callable object
         template<typename Callable>
-        void bind(Callable&& callable)
+        constexpr void bind(Callable&& callable)
         requires std::same_as<std::invoke_result_t<std::decay_t<Callable>, Args...>, Ret>
                  && std::is_empty_v<std::decay_t<Callable>>
+                 && details::nothrow_invocable_if<NoExcept, std::decay_t<Callable>, Args...>
         {
             if constexpr (requires { ptr = nullptr; })
                 ptr = nullptr;
             else
                 ptr.reset();
-            invoker = StaticLambdaInvoker<Callable{}>;
+            invoker = StaticLambdaInvoker<std::decay_t<Callable>{}>;
         }
 
-        bool is_bound() const { return ptr != nullptr; }
-        operator bool() const { return ptr != nullptr; }
+        //static and stateless targets leave ptr empty, the invoker tells whether anything is bound
+        constexpr bool is_bound() const { return invoker != nullptr; }
+        constexpr operator bool() const { return invoker != nullptr; }
 
-        Ret invoke(Args... args)
+        Ret invoke(Args... args) noexcept(NoExcept)
         {
             void* c;
             if constexpr (requires { static_cast<void*>(ptr); })
@@ -138,7 +159,7 @@ namespace auto_delegate
             return reinterpret_cast<invoker_t>(invoker)(c, std::forward<Args>(args)...);
         }
 
-        Ret operator()(Args... args)
+        Ret operator()(Args... args) noexcept(NoExcept)
         {
             return invoke(std::forward<Args>(args)...);
         }
@@ -149,6 +170,7 @@ namespace auto_delegate
                 ptr = nullptr;
             else
                 ptr.reset();
+            invoker = nullptr;
         }
     };
 
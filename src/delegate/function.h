@@ -3,11 +3,101 @@
 #include <concepts>
 #include <cstring>
 #include <cassert>
+#include <atomic>
 #include "function_traits.h"
+#include "function_telemetry.h"
 #include <typeinfo>
 #include <cstdint>
 #include <cstddef>
 #include <optional>
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <tuple>
+
+#ifdef _MSC_VER
+#define FUNCTION_no_unique_address msvc::no_unique_address
+#else
+#define FUNCTION_no_unique_address no_unique_address
+#endif
+
+namespace auto_delegate
+{
+    template<typename FuncT>
+    class function_ref;
+
+    //opt-in trait for types that can be moved by memcpy, skipping the move constructor and the destructor of the source
+    //specialize it or declare `static constexpr bool is_trivially_relocatable = true;` in the type
+    template<typename T>
+    struct is_trivially_relocatable : std::bool_constant<std::is_trivially_copyable_v<T>> {};
+
+    template<typename T> requires requires { { T::is_trivially_relocatable } -> std::convertible_to<bool>; }
+    struct is_trivially_relocatable<T> : std::bool_constant<T::is_trivially_relocatable> {};
+
+    template<typename T, typename Deleter>
+    struct is_trivially_relocatable<std::unique_ptr<T, Deleter>> : is_trivially_relocatable<Deleter> {};
+
+    template<typename T>
+    struct is_trivially_relocatable<std::shared_ptr<T>> : std::true_type {};
+
+    template<typename T>
+    struct is_trivially_relocatable<std::weak_ptr<T>> : std::true_type {};
+
+    //the standard allocators are stateless or a single pointer, whatever their copy constructor looks like
+    template<typename T>
+    struct is_trivially_relocatable<std::allocator<T>> : std::true_type {};
+
+    template<typename T>
+    struct is_trivially_relocatable<std::pmr::polymorphic_allocator<T>> : std::true_type {};
+
+    template<typename T>
+    constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+    //a callable that can outlive its target reports it through expired(), multicast containers sweep expired listeners
+    template<typename T>
+    concept expirable = requires(const T& callable) { { callable.expired() } -> std::convertible_to<bool>; };
+
+    //identifies a type without rtti, the address of a per type static
+    using type_id_t = const void*;
+
+    namespace details
+    {
+        template<typename T>
+        struct type_id_tag
+        {
+            //mutable, so identical constants can not be folded into one address
+            inline static char id = 0;
+        };
+    }
+
+    template<typename T>
+    constexpr type_id_t type_id() noexcept
+    {
+        return &details::type_id_tag<T>::id;
+    }
+
+    //closure types can not be specialized by name, wrap them to opt in
+    template<typename Callable>
+    struct trivially_relocatable_callable : Callable
+    {
+        using Callable::operator();
+        static constexpr bool is_trivially_relocatable = true;
+    };
+
+    template<typename Callable>
+    trivially_relocatable_callable<std::decay_t<Callable>> make_trivially_relocatable(Callable&& callable)
+    {
+        return {std::forward<Callable>(callable)};
+    }
+
+    //store the callable in an immutable reference counted box, copies of the function share it
+    struct shared_box_t
+    {
+        explicit shared_box_t() = default;
+    };
+
+    inline constexpr shared_box_t shared_box{};
+}
 
 namespace auto_delegate::function_v1
 {
@@ -18,15 +108,46 @@ namespace auto_delegate::function_v1
             st_copy,
             st_move,
             st_delete,
-            st_get_type_info
+            st_get_type_info,
+            st_get_type_id,
+            st_get_pointer,
+            st_invoke_batch,
+            st_expired
         };
 
-        template<typename T, typename RTTI_T, typename Ret, typename... Args> requires std::copy_constructible<T> and std::move_constructible<T>
+        //address of the stored callable, boxes forward to the callable they own
+        template<typename T>
+        struct box_traits
+        {
+            static const void* target(const T& self) { return std::addressof(self); }
+            static T& callee(T& self) { return self; }
+        };
+
+        //a callable takes a whole batch of argument packs by declaring invoke_batch(std::span<const std::tuple<Args...>>)
+        template<typename Callee, typename... Args>
+        concept batch_invocable = requires(Callee&& callee, std::span<const std::tuple<Args...>> batch)
+        {
+            std::forward<Callee>(callee).invoke_batch(batch);
+        };
+
+        //move only callable is accepted for unique_function, which never request st_copy
+        template<typename T, typename RTTI_T, typename Ret, typename... Args> requires std::move_constructible<T>
         struct functor_object_traits
         {
-            static Ret invoker(void* self, Args... args)
+            //const signature invokes the callable through a const reference
+            template<bool Const, bool NoExcept>
+            static Ret invoker(void* self, Args... args) noexcept(NoExcept)
             {
-                T& self_ = *static_cast<T*>(self);
+                using self_t = std::conditional_t<Const, const T, T>;
+                self_t& self_ = *static_cast<self_t*>(self);
+                return self_(std::forward<Args>(args)...);
+            }
+
+            //stateless callable is created on call, nothing is read from the buffer
+            template<bool Const, bool NoExcept>
+            static Ret stateless_invoker(void*, Args... args) noexcept(NoExcept)
+            {
+                std::conditional_t<Const, const T, T> self_{};
                 return self_(std::forward<Args>(args)...);
             }
 
@@ -37,7 +158,10 @@ namespace auto_delegate::function_v1
                 switch (op)
                 {
                     case func_storage_op::st_copy:
-                        ::new(self) T((const T&) other_);
+                        if constexpr (std::copy_constructible<T>)
+                            ::new(self) T((const T&) other_);
+                        else
+                            assert(false);
                         break;
                     case func_storage_op::st_move:
                         ::new(self) T(std::move(other_));
@@ -49,6 +173,24 @@ namespace auto_delegate::function_v1
                         case func_storage_op::st_get_type_info:
                             return &typeid(RTTI_T);
 #endif
+                    case func_storage_op::st_get_type_id:
+                        return type_id<RTTI_T>();
+                    case func_storage_op::st_get_pointer:
+                        return box_traits<T>::target(self_);
+                    case func_storage_op::st_invoke_batch:
+                        //non null when the callable handled the batch
+                        if constexpr (batch_invocable<decltype(box_traits<T>::callee(self_)), Args...>)
+                        {
+                            box_traits<T>::callee(self_).invoke_batch(
+                                    *static_cast<const std::span<const std::tuple<Args...>>*>(other));
+                            return self;
+                        }
+                        break;
+                    case func_storage_op::st_expired:
+                        //non null when the callable reports its target gone
+                        if constexpr (expirable<std::remove_cvref_t<decltype(box_traits<T>::callee(self_))>>)
+                            return box_traits<T>::callee(self_).expired() ? self : nullptr;
+                        break;
                 }
                 return nullptr;
             }
@@ -57,46 +199,190 @@ namespace auto_delegate::function_v1
                     std::is_trivially_copyable_v<T>
                     and std::is_trivially_move_constructible_v<T>
                     and std::is_trivially_destructible_v<T>;
+
+            static constexpr bool is_relocatable = is_trivially_relocatable_v<T>;
+
+            //captureless lambdas, can be constructed in constant evaluation
+            static constexpr bool is_stateless =
+                    std::is_empty_v<T>
+                    and std::is_trivially_default_constructible_v<T>
+                    and std::is_trivially_copyable_v<T>;
         };
 
 
-        template<typename Callable, typename Ret, typename... Args>
+        // callable that exceed the small buffer is allocated by Alloc
+        // the allocator is carried by the box so copies allocate from the same resource
+        template<typename Callable, typename Alloc, typename Ret, typename... Args>
         struct functor_box_wrapper
         {
+            using allocator_t = typename std::allocator_traits<Alloc>::template rebind_alloc<Callable>;
+            using allocator_traits_t = std::allocator_traits<allocator_t>;
+
             Callable* callee;
+            [[FUNCTION_no_unique_address]] allocator_t allocator;
+
+            //only the pointer and the allocator live in the small buffer
+            static constexpr bool is_trivially_relocatable = is_trivially_relocatable_v<allocator_t>;
 
             template<typename Other>
-            explicit functor_box_wrapper(Other&& callee)
-                    : callee(new Callable(std::forward<Other>(callee))) {}
+            explicit functor_box_wrapper(const Alloc& alloc, Other&& callee)
+                    : callee(), allocator(alloc)
+            {
+                this->callee = create(std::forward<Other>(callee));
+            }
 
-            functor_box_wrapper(const functor_box_wrapper& other)
-                    : callee(new Callable(*other.callee)) {}
+            functor_box_wrapper(const functor_box_wrapper& other) requires std::copy_constructible<Callable>
+                    : callee(), allocator(other.allocator)
+            {
+                callee = create(*other.callee);
+            }
 
             functor_box_wrapper(functor_box_wrapper&& other) noexcept
-                    : callee(other.callee) { other.callee = nullptr; }
+                    : callee(other.callee), allocator(other.allocator) { other.callee = nullptr; }
 
-            ~functor_box_wrapper() { delete callee; }
+            ~functor_box_wrapper()
+            {
+                if (not callee) return;
+                allocator_traits_t::destroy(allocator, callee);
+                allocator_traits_t::deallocate(allocator, callee, 1);
+            }
 
-            Ret operator()(Args... args)
+            Ret operator()(Args... args) noexcept(std::is_nothrow_invocable_v<Callable&, Args...>)
             {
                 return (*callee)(std::forward<Args>(args)...);
             }
 
+            Ret operator()(Args... args) const noexcept(std::is_nothrow_invocable_v<const Callable&, Args...>)
+            requires std::invocable<const Callable&, Args...>
+            {
+                return static_cast<const Callable&>(*callee)(std::forward<Args>(args)...);
+            }
+
             const Callable* get() const noexcept { return callee; }
+
+        private:
+            template<typename Other>
+            Callable* create(Other&& other)
+            {
+                Callable* p = allocator_traits_t::allocate(allocator, 1);
+                try
+                {
+                    allocator_traits_t::construct(allocator, p, std::forward<Other>(other));
+                } catch (...)
+                {
+                    allocator_traits_t::deallocate(allocator, p, 1);
+                    throw;
+                }
+                return p;
+            }
+        };
+
+        template<typename Callable, typename Alloc, typename Ret, typename... Args>
+        struct box_traits<functor_box_wrapper<Callable, Alloc, Ret, Args...>>
+        {
+            static const void* target(const functor_box_wrapper<Callable, Alloc, Ret, Args...>& self) { return self.get(); }
+            static Callable& callee(functor_box_wrapper<Callable, Alloc, Ret, Args...>& self) { return *self.callee; }
+        };
+
+        // immutable callable shared by every copy, copying only increases the reference count
+        // the node carries the allocator so the last owner can release it
+        template<typename Callable, typename Alloc, typename Ret, typename... Args>
+        struct functor_shared_box_wrapper
+        {
+            struct node_t
+            {
+                using allocator_t = typename std::allocator_traits<Alloc>::template rebind_alloc<node_t>;
+
+                std::atomic<size_t> ref_count;
+                [[FUNCTION_no_unique_address]] allocator_t allocator;
+                const Callable callee;
+
+                template<typename Other>
+                node_t(const allocator_t& alloc, Other&& callee)
+                        : ref_count(1), allocator(alloc), callee(std::forward<Other>(callee)) {}
+            };
+
+            using allocator_t = typename node_t::allocator_t;
+            using allocator_traits_t = std::allocator_traits<allocator_t>;
+
+            node_t* node;
+
+            //only the node pointer lives in the small buffer
+            static constexpr bool is_trivially_relocatable = true;
+
+            template<typename Other>
+            explicit functor_shared_box_wrapper(const Alloc& alloc, Other&& callee)
+                    : node()
+            {
+                allocator_t allocator(alloc);
+                node_t* p = allocator_traits_t::allocate(allocator, 1);
+                try
+                {
+                    allocator_traits_t::construct(allocator, p, allocator, std::forward<Other>(callee));
+                } catch (...)
+                {
+                    allocator_traits_t::deallocate(allocator, p, 1);
+                    throw;
+                }
+                node = p;
+            }
+
+            functor_shared_box_wrapper(const functor_shared_box_wrapper& other) noexcept
+                    : node(other.node)
+            {
+                node->ref_count.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            functor_shared_box_wrapper(functor_shared_box_wrapper&& other) noexcept
+                    : node(other.node) { other.node = nullptr; }
+
+            ~functor_shared_box_wrapper()
+            {
+                if (not node) return;
+                if (node->ref_count.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+                allocator_t allocator(node->allocator);
+                allocator_traits_t::destroy(allocator, node);
+                allocator_traits_t::deallocate(allocator, node, 1);
+            }
+
+            //the shared callable is never mutated, it is only invoked through a const reference
+            Ret operator()(Args... args) const noexcept(std::is_nothrow_invocable_v<const Callable&, Args...>)
+            {
+                return node->callee(std::forward<Args>(args)...);
+            }
+
+            const Callable* get() const noexcept { return std::addressof(node->callee); }
+        };
+
+        template<typename Callable, typename Alloc, typename Ret, typename... Args>
+        struct box_traits<functor_shared_box_wrapper<Callable, Alloc, Ret, Args...>>
+        {
+            static const void* target(const functor_shared_box_wrapper<Callable, Alloc, Ret, Args...>& self) { return self.get(); }
+            static const Callable& callee(functor_shared_box_wrapper<Callable, Alloc, Ret, Args...>& self) { return *self.get(); }
         };
     }
 
-    template<typename FuncT, size_t SOB = 48>
+    template<typename FuncT, size_t SOB = 48, typename Alloc = std::allocator<std::byte>>
     struct function;
 
+    template<typename FuncT, size_t SOB = 48, typename Alloc = std::allocator<std::byte>>
+    class unique_function;
+
     template<typename Callable>
     function(Callable&&) -> function<typename details::function_traits<std::decay_t<Callable>>::decay_function_type>;
 
-    template<typename Ret, typename... Args, size_t SOB>
-    class function<Ret(Args...), SOB>
+    template<typename Ret, typename... Args, bool NoExcept, size_t SOB, typename Alloc>
+    class function<Ret(Args...) noexcept(NoExcept), SOB, Alloc>
     {
         static_assert(SOB % 8 == 0);
-        using invoker_t = Ret (*)(void*, Args...);
+        template<typename, size_t, typename>
+        friend class unique_function;
+        template<typename>
+        friend class auto_delegate::function_ref;
+    public:
+        using allocator_t = Alloc;
+    private:
+        using invoker_t = Ret (*)(void*, Args...) noexcept(NoExcept);
         using manager_t = const void* (*)(void*, void*, internal::func_storage_op);
 
         alignas(std::max_align_t) void* data[SOB / sizeof(void*)];
@@ -104,246 +390,677 @@ namespace auto_delegate::function_v1
         manager_t manager;
         static constexpr size_t inline_storage_size = sizeof(data);
         static constexpr uintptr_t non_trivial_bit_mask = uintptr_t(1) << (sizeof(uintptr_t)*8-1);
-        static constexpr uintptr_t pointer_mask = ~non_trivial_bit_mask;
+        static constexpr uintptr_t relocatable_bit_mask = non_trivial_bit_mask >> 1;
+        static constexpr uintptr_t tag_mask = non_trivial_bit_mask | relocatable_bit_mask;
+        static constexpr uintptr_t pointer_mask = ~tag_mask;
 
         [[nodiscard]] bool non_trivial() const
         {
             return uintptr_t(manager) & non_trivial_bit_mask;
         }
 
+        //trivial or trivially relocatable, the storage can be moved by memcpy
+        [[nodiscard]] bool relocatable() const
+        {
+            return (uintptr_t(manager) & tag_mask) != non_trivial_bit_mask;
+        }
+
         const void* manage(void* self, void* other, internal::func_storage_op op) const
         {
             auto m = manager_t(uintptr_t(manager) & pointer_mask);
             return m(self, other, op);
         }
 
-        void set_manager_trivial(manager_t m, bool trivial)
+        void set_manager_and_tags(manager_t m, bool trivial, bool relocatable)
         {
             uintptr_t& ptr = *(uintptr_t*) &m;
-            assert((ptr & non_trivial_bit_mask) == 0);
+            assert((ptr & tag_mask) == 0);
             if (not trivial) ptr |= non_trivial_bit_mask;
+            if (relocatable) ptr |= relocatable_bit_mask;
             manager = manager_t(ptr);
         }
 
+        template<typename Callable, bool Const>
+        static constexpr bool storage_invocable =
+                std::is_invocable_v<std::conditional_t<Const, const Callable&, Callable&>, Args...>;
+
+        //the invoker construct installs for Callable, shared boxes are not expected
+        template<typename Callable, bool Const> requires storage_invocable<Callable, Const>
+        static constexpr invoker_t storage_invoker()
+        {
+            using callable_t = Callable;
+            if constexpr (internal::functor_object_traits<callable_t, callable_t, Ret, Args...>::is_stateless)
+                return internal::functor_object_traits<callable_t, callable_t, Ret, Args...>::template stateless_invoker<Const, NoExcept>;
+            else if constexpr (sizeof(callable_t) <= inline_storage_size)
+                return internal::functor_object_traits<callable_t, callable_t, Ret, Args...>::template invoker<Const, NoExcept>;
+            else
+            {
+                using inline_functor_t = internal::functor_box_wrapper<callable_t, Alloc, Ret, Args...>;
+                return internal::functor_object_traits<inline_functor_t, callable_t, Ret, Args...>::template invoker<Const, NoExcept>;
+            }
+        }
+
     public:
         template<typename Callable>
         requires std::same_as<std::invoke_result_t<Callable, Args...>, Ret>
-                 and (not std::same_as<std::decay_t<Callable>, function>)
+                 and (not std::derived_from<std::decay_t<Callable>, function>)
                  and std::move_constructible<Callable>
                  and std::copy_constructible<Callable>
-        function(Callable&& callable)
+                 and details::nothrow_invocable_if<NoExcept, std::decay_t<Callable>&, Args...>
+        constexpr function(Callable&& callable)
+                : function(std::allocator_arg, allocator_t(), std::forward<Callable>(callable)) {}
+
+        //the allocator is only used when the callable does not fit in the small buffer
+        template<typename Callable>
+        requires std::same_as<std::invoke_result_t<Callable, Args...>, Ret>
+                 and (not std::derived_from<std::decay_t<Callable>, function>)
+                 and std::move_constructible<Callable>
+                 and std::copy_constructible<Callable>
+                 and details::nothrow_invocable_if<NoExcept, std::decay_t<Callable>&, Args...>
+        constexpr function(std::allocator_arg_t, const allocator_t& alloc, Callable&& callable)
+        {
+            construct<false>(alloc, std::forward<Callable>(callable));
+        }
+
+        //the callable is boxed once and shared by copies, it must be invocable through a const reference
+        template<typename Callable>
+        requires std::same_as<std::invoke_result_t<const std::decay_t<Callable>&, Args...>, Ret>
+                 and std::constructible_from<std::decay_t<Callable>, Callable>
+                 and details::nothrow_invocable_if<NoExcept, const std::decay_t<Callable>&, Args...>
+        function(shared_box_t tag, Callable&& callable)
+                : function(std::allocator_arg, allocator_t(), tag, std::forward<Callable>(callable)) {}
+
+        template<typename Callable>
+        requires std::same_as<std::invoke_result_t<const std::decay_t<Callable>&, Args...>, Ret>
+                 and std::constructible_from<std::decay_t<Callable>, Callable>
+                 and details::nothrow_invocable_if<NoExcept, const std::decay_t<Callable>&, Args...>
+        function(std::allocator_arg_t, const allocator_t& alloc, shared_box_t, Callable&& callable)
+        {
+            construct_shared<false>(alloc, std::forward<Callable>(callable));
+        }
+
+    protected:
+        //the telemetry counters of the declared type, the const signature shares the storage of this one
+        template<bool Const>
+        using telemetry_key = function<std::conditional_t<Const, Ret(Args...) const noexcept(NoExcept), Ret(Args...) noexcept(NoExcept)>, SOB, Alloc>;
+
+        template<bool Const, typename Callable>
+        void construct_shared(const allocator_t& alloc, Callable&& callable)
         {
             using callable_t = std::decay_t<Callable>;
-            if constexpr (sizeof(callable_t) <= inline_storage_size)
+            using inline_functor_t = internal::functor_shared_box_wrapper<callable_t, Alloc, Ret, Args...>;
+            static_assert(sizeof(inline_functor_t) <= inline_storage_size);
+            using traits = internal::functor_object_traits<inline_functor_t, callable_t, Ret, Args...>;
+            telemetry::internal::record_shared_construction<telemetry_key<Const>>();
+            ::new(data) inline_functor_t(alloc, std::forward<Callable>(callable));
+            invoker = traits::template invoker<true, NoExcept>;
+            set_manager_and_tags(traits::manager, false, traits::is_relocatable);
+        }
+
+        template<bool Const, typename Callable>
+        constexpr void construct(const allocator_t& alloc, Callable&& callable)
+        {
+            using callable_t = std::decay_t<Callable>;
+            if (not std::is_constant_evaluated())
+                telemetry::internal::record_construction<telemetry_key<Const>, callable_t, inline_storage_size>();
+            if constexpr (internal::functor_object_traits<callable_t, callable_t, Ret, Args...>::is_stateless)
+            {
+                //no object is placed in the buffer, so a table of them can be constinit
+                using traits = internal::functor_object_traits<callable_t, callable_t, Ret, Args...>;
+                for (auto& p: data) p = nullptr;
+                invoker = traits::template stateless_invoker<Const, NoExcept>;
+                manager = traits::manager;
+            } else if constexpr (sizeof(callable_t) <= inline_storage_size)
             {
                 using inline_functor_t = callable_t;
                 using traits = internal::functor_object_traits<inline_functor_t, callable_t, Ret, Args...>;
                 ::new(data) inline_functor_t(std::forward<Callable>(callable));
-                invoker = traits::invoker;
-                set_manager_trivial(traits::manager, traits::is_trivial);
+                invoker = traits::template invoker<Const, NoExcept>;
+                set_manager_and_tags(traits::manager, traits::is_trivial, traits::is_relocatable);
             } else
             {
-                using inline_functor_t = internal::functor_box_wrapper<callable_t, Ret, Args...>;
+                using inline_functor_t = internal::functor_box_wrapper<callable_t, Alloc, Ret, Args...>;
+                static_assert(sizeof(inline_functor_t) <= inline_storage_size, "allocator is too large for the small buffer");
                 using traits = internal::functor_object_traits<inline_functor_t, callable_t, Ret, Args...>;
-                ::new(data) inline_functor_t(std::forward<Callable>(callable));
-                invoker = traits::invoker;
-                set_manager_trivial(traits::manager, false);
+                ::new(data) inline_functor_t(alloc, std::forward<Callable>(callable));
+                invoker = traits::template invoker<Const, NoExcept>;
+                set_manager_and_tags(traits::manager, false, traits::is_relocatable);
             }
         }
 
-
-        function() : invoker(nullptr), manager(nullptr) {}
-
-        function(const function& other) : invoker(other.invoker), manager(other.manager)
+        template<bool Const>
+        function(const function& other, std::bool_constant<Const>) : invoker(other.invoker), manager(other.manager)
         {
+            telemetry::internal::record_copy<telemetry_key<Const>>();
             if (non_trivial()) manage(data, (void*) other.data, internal::func_storage_op::st_copy);
             else std::memcpy(data, other.data, sizeof(data));
         }
 
-        function(function&& other) noexcept: invoker(other.invoker), manager(other.manager)
+        template<bool Const>
+        function(function&& other, std::bool_constant<Const>) noexcept: invoker(other.invoker), manager(other.manager)
         {
-            if (non_trivial()) manage(data, other.data, internal::func_storage_op::st_move);
-            else std::memcpy(data, other.data, sizeof(data));
+            telemetry::internal::record_move<telemetry_key<Const>>();
+            if (relocatable()) std::memcpy(data, other.data, sizeof(data));
+            else manage(data, other.data, internal::func_storage_op::st_move);
             other.invoker = nullptr;
             other.manager = nullptr;
         }
 
-        ~function()
+        template<bool Const>
+        void swap(function& other, std::bool_constant<Const> key) noexcept
         {
-            if (non_trivial()) manage(data, nullptr, internal::func_storage_op::st_delete);
+            if (relocatable() and other.relocatable())
+            {
+                alignas(function) std::byte temp[sizeof(function)];
+                std::memcpy(temp, (void*) this, sizeof(function));
+                std::memcpy((void*) this, (void*) &other, sizeof(function));
+                std::memcpy((void*) &other, temp, sizeof(function));
+                return;
+            }
+            function temp(std::move(other), key);
+            ::new(&other) function(std::move(*this), key);
+            ::new(this) function(std::move(temp), key);
         }
 
-        void swap(function& other) noexcept
+    public:
+        constexpr function() : data{}, invoker(nullptr), manager(nullptr) {}
+
+        function(const function& other) : function(other, std::false_type()) {}
+
+        function(function&& other) noexcept: function(std::move(other), std::false_type()) {}
+
+        constexpr ~function()
         {
-            function temp = std::move(other);
-            ::new(&other) function(std::move(*this));
-            ::new(this) function(std::move(temp));
+            //only stateless callables are created in constant evaluation
+            if (std::is_constant_evaluated()) return;
+            if (non_trivial()) manage(data, nullptr, internal::func_storage_op::st_delete);
         }
 
+        void swap(function& other) noexcept { swap(other, std::false_type()); }
+
         function& operator=(const function& other)
         {
             function(other).swap(*this);
             return *this;
         }
 
-        function& operator=(function&& other)
+        function& operator=(function&& other) noexcept
         {
-            function(std::move(other)).swap(*this);
+            //move in place, a relocatable callable is moved by memcpy
+            if (this == &other) return *this;
+            this->~function();
+            ::new(this) function(std::move(other));
             return *this;
         }
 
         template<typename Callable>
-        requires (not std::same_as<std::decay_t<Callable>, function>)
+        requires (not std::derived_from<std::decay_t<Callable>, function>)
         function& operator=(Callable&& callable)
         {
             function(std::forward<Callable>(callable)).swap(*this);
             return *this;
         }
 
-        Ret operator()(Args... args) const
+        Ret operator()(Args... args) const noexcept(NoExcept)
         {
             return invoker((void*) data, std::forward<Args>(args)...);
         }
 
+        //one call when the callable declares invoke_batch, otherwise one call per argument pack
+        void invoke_batch(std::span<const std::tuple<Args...>> batch) const noexcept(NoExcept) requires std::same_as<Ret, void>
+        {
+            if (manage((void*) data, &batch, internal::func_storage_op::st_invoke_batch)) return;
+            for (auto& args: batch)
+                std::apply([this](auto& ... a) { invoker((void*) data, a...); }, args);
+        }
+
         operator bool() const noexcept { return invoker != nullptr; }
 
+        //true when the stored callable is expirable and its target is gone
+        [[nodiscard]] bool expired() const noexcept
+        {
+            return manager and manage((void*) data, nullptr, internal::func_storage_op::st_expired);
+        }
+
 #if __cpp_rtti
         [[nodiscard]] const std::type_info& target_type() const noexcept
         {
             return *static_cast<const std::type_info*>(manage(nullptr, nullptr, internal::func_storage_op::st_get_type_info));
         }
+#endif
+        //available without rtti, an empty function reports void
+        [[nodiscard]] type_id_t target_type_id() const noexcept
+        {
+            if (not manager) return type_id<void>();
+            return manage(nullptr, nullptr, internal::func_storage_op::st_get_type_id);
+        }
+
         template<typename Callable>
         [[nodiscard]] const Callable* target() const noexcept
         {
             using callable_t = Callable;
-            if(typeid(callable_t) != target_type()) return nullptr;
-            if constexpr (sizeof(callable_t) <= inline_storage_size)
+            if (target_type_id() != type_id<callable_t>()) return nullptr;
+            //the storage reports where the callable lives, inline or in a box
+            return static_cast<const callable_t*>(manage((void*) data, nullptr, internal::func_storage_op::st_get_pointer));
+        }
+
+        //call Callable through a direct call when it is the stored callable, otherwise fall back to the invoker
+        template<typename Callable>
+        Ret invoke_as(Args... args) const noexcept(NoExcept)
+        {
+            if constexpr (storage_invocable<Callable, false>)
             {
-                using inline_functor_t = callable_t;
-                return static_cast<const inline_functor_t*>(data);
+                constexpr invoker_t expected = storage_invoker<Callable, false>();
+                if (invoker == expected) return expected((void*) data, std::forward<Args>(args)...);
             }
-            else
+            if constexpr (storage_invocable<Callable, true>)
             {
-                using inline_functor_t = internal::functor_box_wrapper<callable_t, Ret, Args...>;
-                return static_cast<const inline_functor_t*>(data)->get();
+                constexpr invoker_t expected = storage_invoker<Callable, true>();
+                if (invoker == expected) return expected((void*) data, std::forward<Args>(args)...);
             }
+            return invoker((void*) data, std::forward<Args>(args)...);
         }
-#endif
     };
-}
 
-namespace auto_delegate::function_v2
-{
-    struct function_validate_tag {};
+    //const signature, the callable is always invoked through a const reference
+    template<typename Ret, typename... Args, bool NoExcept, size_t SOB, typename Alloc>
+    class function<Ret(Args...) const noexcept(NoExcept), SOB, Alloc>
+            : public function<Ret(Args...) noexcept(NoExcept), SOB, Alloc>
+    {
+        using super = function<Ret(Args...) noexcept(NoExcept), SOB, Alloc>;
+    public:
+        using typename super::allocator_t;
 
-    namespace internal
+        template<typename Callable>
+        requires std::same_as<std::invoke_result_t<const std::decay_t<Callable>&, Args...>, Ret>
+                 and (not std::derived_from<std::decay_t<Callable>, super>)
+                 and std::copy_constructible<std::decay_t<Callable>>
+                 and details::nothrow_invocable_if<NoExcept, const std::decay_t<Callable>&, Args...>
+        constexpr function(Callable&& callable)
+                : function(std::allocator_arg, allocator_t(), std::forward<Callable>(callable)) {}
+
+        template<typename Callable>
+        requires std::same_as<std::invoke_result_t<const std::decay_t<Callable>&, Args...>, Ret>
+                 and (not std::derived_from<std::decay_t<Callable>, super>)
+                 and std::copy_constructible<std::decay_t<Callable>>
+                 and details::nothrow_invocable_if<NoExcept, const std::decay_t<Callable>&, Args...>
+        constexpr function(std::allocator_arg_t, const allocator_t& alloc, Callable&& callable)
+        {
+            super::template construct<true>(alloc, std::forward<Callable>(callable));
+        }
+
+        template<typename Callable>
+        requires std::constructible_from<super, shared_box_t, Callable>
+        function(shared_box_t tag, Callable&& callable)
+                : function(std::allocator_arg, allocator_t(), tag, std::forward<Callable>(callable)) {}
+
+        template<typename Callable>
+        requires std::constructible_from<super, std::allocator_arg_t, const allocator_t&, shared_box_t, Callable>
+        function(std::allocator_arg_t, const allocator_t& alloc, shared_box_t, Callable&& callable)
+        {
+            super::template construct_shared<true>(alloc, std::forward<Callable>(callable));
+        }
+
+        function() = default;
+
+        function(const function& other) : super(other, std::true_type()) {}
+
+        function(function&& other) noexcept: super(std::move(other), std::true_type()) {}
+
+        function& operator=(const function& other)
+        {
+            function(other).swap(*this);
+            return *this;
+        }
+
+        function& operator=(function&& other) noexcept
+        {
+            if (this == &other) return *this;
+            this->~function();
+            ::new(this) function(std::move(other));
+            return *this;
+        }
+
+        void swap(function& other) noexcept { super::swap(other, std::true_type()); }
+
+        template<typename Callable>
+        requires (not std::derived_from<std::decay_t<Callable>, super>)
+        function& operator=(Callable&& callable)
+        {
+            function(std::forward<Callable>(callable)).swap(*this);
+            return *this;
+        }
+    };
+
+    template<typename Callable>
+    unique_function(Callable&&) -> unique_function<typename details::function_traits<std::decay_t<Callable>>::decay_function_type>;
+
+    //move only function, share the same storage layout with function
+    template<typename Ret, typename... Args, bool NoExcept, size_t SOB, typename Alloc>
+    class unique_function<Ret(Args...) noexcept(NoExcept), SOB, Alloc>
     {
-        enum class func_storage_op
+        static_assert(SOB % 8 == 0);
+        template<typename>
+        friend class auto_delegate::function_ref;
+    public:
+        using allocator_t = Alloc;
+    private:
+        using invoker_t = Ret (*)(void*, Args...) noexcept(NoExcept);
+        using manager_t = const void* (*)(void*, void*, internal::func_storage_op);
+        using copyable_function_t = function<Ret(Args...) noexcept(NoExcept), SOB, Alloc>;
+
+        alignas(std::max_align_t) void* data[SOB / sizeof(void*)];
+        invoker_t invoker;
+        manager_t manager;
+        static constexpr size_t inline_storage_size = sizeof(data);
+        static constexpr uintptr_t non_trivial_bit_mask = uintptr_t(1) << (sizeof(uintptr_t)*8-1);
+        static constexpr uintptr_t relocatable_bit_mask = non_trivial_bit_mask >> 1;
+        static constexpr uintptr_t tag_mask = non_trivial_bit_mask | relocatable_bit_mask;
+        static constexpr uintptr_t pointer_mask = ~tag_mask;
+
+        [[nodiscard]] bool non_trivial() const
         {
-            st_copy,
-            st_move,
-            st_delete,
-            st_get_type_info
-        };
+            return uintptr_t(manager) & non_trivial_bit_mask;
+        }
 
-        enum class func_invoke_op
+        //trivial or trivially relocatable, the storage can be moved by memcpy
+        [[nodiscard]] bool relocatable() const
         {
-            validate,
-            invoke
-        };
+            return (uintptr_t(manager) & tag_mask) != non_trivial_bit_mask;
+        }
 
-        struct validation_tag {};
-        struct invoke_tag {};
+        const void* manage(void* self, void* other, internal::func_storage_op op) const
+        {
+            auto m = manager_t(uintptr_t(manager) & pointer_mask);
+            return m(self, other, op);
+        }
 
-        template<typename Ret, typename... Args>
-        struct functor_invoker_traits_validate
+        void set_manager_and_tags(manager_t m, bool trivial, bool relocatable)
         {
-            union invoker_ret_no_ret
+            uintptr_t& ptr = *(uintptr_t*) &m;
+            assert((ptr & tag_mask) == 0);
+            if (not trivial) ptr |= non_trivial_bit_mask;
+            if (relocatable) ptr |= relocatable_bit_mask;
+            manager = manager_t(ptr);
+        }
+
+        template<typename Callable, bool Const>
+        static constexpr bool storage_invocable =
+                std::is_invocable_v<std::conditional_t<Const, const Callable&, Callable&>, Args...>;
+
+        //the invoker construct installs for Callable, shared boxes are not expected
+        template<typename Callable, bool Const> requires storage_invocable<Callable, Const>
+        static constexpr invoker_t storage_invoker()
+        {
+            using callable_t = Callable;
+            if constexpr (internal::functor_object_traits<callable_t, callable_t, Ret, Args...>::is_stateless)
+                return internal::functor_object_traits<callable_t, callable_t, Ret, Args...>::template stateless_invoker<Const, NoExcept>;
+            else if constexpr (sizeof(callable_t) <= inline_storage_size)
+                return internal::functor_object_traits<callable_t, callable_t, Ret, Args...>::template invoker<Const, NoExcept>;
+            else
             {
-                bool valid;
+                using inline_functor_t = internal::functor_box_wrapper<callable_t, Alloc, Ret, Args...>;
+                return internal::functor_object_traits<inline_functor_t, callable_t, Ret, Args...>::template invoker<Const, NoExcept>;
+            }
+        }
 
-                invoker_ret_no_ret(validation_tag, bool valid) : valid(valid) {}
+    public:
+        template<typename Callable>
+        requires std::same_as<std::invoke_result_t<Callable, Args...>, Ret>
+                 and (not std::derived_from<std::decay_t<Callable>, unique_function>)
+                 and (not std::same_as<Callable, copyable_function_t>)
+                 and std::move_constructible<std::decay_t<Callable>>
+                 and details::nothrow_invocable_if<NoExcept, std::decay_t<Callable>&, Args...>
+        constexpr unique_function(Callable&& callable)
+                : unique_function(std::allocator_arg, allocator_t(), std::forward<Callable>(callable)) {}
+
+        //the allocator is only used when the callable does not fit in the small buffer
+        template<typename Callable>
+        requires std::same_as<std::invoke_result_t<Callable, Args...>, Ret>
+                 and (not std::derived_from<std::decay_t<Callable>, unique_function>)
+                 and (not std::same_as<Callable, copyable_function_t>)
+                 and std::move_constructible<std::decay_t<Callable>>
+                 and details::nothrow_invocable_if<NoExcept, std::decay_t<Callable>&, Args...>
+        constexpr unique_function(std::allocator_arg_t, const allocator_t& alloc, Callable&& callable)
+        {
+            construct<false>(alloc, std::forward<Callable>(callable));
+        }
 
-                invoker_ret_no_ret() {}
-            };
+    protected:
+        //the telemetry counters of the declared type, the const signature shares the storage of this one
+        template<bool Const>
+        using telemetry_key = unique_function<std::conditional_t<Const, Ret(Args...) const noexcept(NoExcept), Ret(Args...) noexcept(NoExcept)>, SOB, Alloc>;
+
+        template<bool Const, typename Callable>
+        constexpr void construct(const allocator_t& alloc, Callable&& callable)
+        {
+            using callable_t = std::decay_t<Callable>;
+            if (not std::is_constant_evaluated())
+                telemetry::internal::record_construction<telemetry_key<Const>, callable_t, inline_storage_size>();
+            if constexpr (internal::functor_object_traits<callable_t, callable_t, Ret, Args...>::is_stateless)
+            {
+                //no object is placed in the buffer, so a table of them can be constinit
+                using traits = internal::functor_object_traits<callable_t, callable_t, Ret, Args...>;
+                for (auto& p: data) p = nullptr;
+                invoker = traits::template stateless_invoker<Const, NoExcept>;
+                manager = traits::manager;
+            } else if constexpr (sizeof(callable_t) <= inline_storage_size)
+            {
+                using inline_functor_t = callable_t;
+                using traits = internal::functor_object_traits<inline_functor_t, callable_t, Ret, Args...>;
+                ::new(data) inline_functor_t(std::forward<Callable>(callable));
+                invoker = traits::template invoker<Const, NoExcept>;
+                set_manager_and_tags(traits::manager, traits::is_trivial, traits::is_relocatable);
+            } else
+            {
+                using inline_functor_t = internal::functor_box_wrapper<callable_t, Alloc, Ret, Args...>;
+                static_assert(sizeof(inline_functor_t) <= inline_storage_size, "allocator is too large for the small buffer");
+                using traits = internal::functor_object_traits<inline_functor_t, callable_t, Ret, Args...>;
+                ::new(data) inline_functor_t(alloc, std::forward<Callable>(callable));
+                invoker = traits::template invoker<Const, NoExcept>;
+                set_manager_and_tags(traits::manager, false, traits::is_relocatable);
+            }
+        }
+
+        template<bool Const>
+        unique_function(unique_function&& other, std::bool_constant<Const>) noexcept: invoker(other.invoker), manager(other.manager)
+        {
+            telemetry::internal::record_move<telemetry_key<Const>>();
+            if (relocatable()) std::memcpy(data, other.data, sizeof(data));
+            else manage(data, other.data, internal::func_storage_op::st_move);
+            other.invoker = nullptr;
+            other.manager = nullptr;
+        }
 
-            union invoker_ret_with_ret
+        template<bool Const>
+        void swap(unique_function& other, std::bool_constant<Const> key) noexcept
+        {
+            if (relocatable() and other.relocatable())
             {
-                Ret ret;
-                bool valid;
+                alignas(unique_function) std::byte temp[sizeof(unique_function)];
+                std::memcpy(temp, (void*) this, sizeof(unique_function));
+                std::memcpy((void*) this, (void*) &other, sizeof(unique_function));
+                std::memcpy((void*) &other, temp, sizeof(unique_function));
+                return;
+            }
+            unique_function temp(std::move(other), key);
+            ::new(&other) unique_function(std::move(*this), key);
+            ::new(this) unique_function(std::move(temp), key);
+        }
 
-                invoker_ret_with_ret(validation_tag, bool valid) : valid(valid) {}
+    public:
+        constexpr unique_function() : data{}, invoker(nullptr), manager(nullptr) {}
 
-                invoker_ret_with_ret(invoke_tag, Ret&& ret) : ret(std::forward<Ret>(ret)) {}
+        unique_function(const unique_function&) = delete;
 
-                invoker_ret_with_ret() {}
-            };
+        unique_function(unique_function&& other) noexcept: unique_function(std::move(other), std::false_type()) {}
 
-            using invoker_ret = std::conditional_t<std::is_void_v<Ret>, invoker_ret_no_ret, invoker_ret_with_ret>;
+        //take over the storage of a copyable function, the callable is not boxed again
+        template<typename Other> requires std::same_as<Other, copyable_function_t>
+        unique_function(Other&& other) noexcept: invoker(other.invoker), manager(other.manager)
+        {
+            telemetry::internal::record_move<telemetry_key<false>>();
+            if (relocatable()) std::memcpy(data, other.data, sizeof(data));
+            else manage(data, other.data, internal::func_storage_op::st_move);
+            other.invoker = nullptr;
+            other.manager = nullptr;
+        }
 
-            using invoker_t = invoker_ret (*)(func_invoke_op, void*, std::tuple<Args...>*);
+        constexpr ~unique_function()
+        {
+            //only stateless callables are created in constant evaluation
+            if (std::is_constant_evaluated()) return;
+            if (non_trivial()) manage(data, nullptr, internal::func_storage_op::st_delete);
+        }
 
-            template<typename T, auto ValidateMemFunc>
-            static invoker_ret invoker_with_validater(func_invoke_op op, void* self, std::tuple<Args...>* args)
-            {
-                T& self_ = *static_cast<T*>(self);
+        void swap(unique_function& other) noexcept { swap(other, std::false_type()); }
 
-                auto invoke = [&]<size_t... I>(std::index_sequence<I...>)
-                {
-                    if constexpr (std::is_void_v<Ret>)
-                    {
-                        self_(std::forward<Args>(std::get<I>(*args))...);
-                        return invoker_ret{};
-                    } else
-                    {
-                        return invoker_ret{invoke_tag{}, self_(std::forward<Args>(std::get<I>(*args))...)};
-                    }
-                };
-
-                if constexpr (ValidateMemFunc == nullptr)
-                    static_assert(!std::same_as<T, T>);//no validation
-                else
-                    switch (op)
-                    {
-                        case func_invoke_op::validate:
-                            return invoker_ret{validation_tag{}, (self_.*ValidateMemFunc)(function_validate_tag{})};
-                        case func_invoke_op::invoke:
-                            return invoke(std::make_index_sequence<sizeof...(Args)>{});
-                        default:
-                            assert(false);
-                            return invoker_ret{};
-                    }
-            }
-        };
+        unique_function& operator=(const unique_function&) = delete;
 
-        template<typename Ret, typename... Args>
-        struct functor_invoker_traits_trivial
+        unique_function& operator=(unique_function&& other) noexcept
         {
-            using invoker_t = Ret(*)(void* self, Args... args);
+            //move in place, a relocatable callable is moved by memcpy
+            if (this == &other) return *this;
+            this->~unique_function();
+            ::new(this) unique_function(std::move(other));
+            return *this;
+        }
 
-            template<typename T>
-            static Ret invoker(void* self, Args... args)
+        template<typename Callable>
+        requires (not std::derived_from<std::decay_t<Callable>, unique_function>)
+        unique_function& operator=(Callable&& callable)
+        {
+            unique_function(std::forward<Callable>(callable)).swap(*this);
+            return *this;
+        }
+
+        Ret operator()(Args... args) const noexcept(NoExcept)
+        {
+            return invoker((void*) data, std::forward<Args>(args)...);
+        }
+
+        //one call when the callable declares invoke_batch, otherwise one call per argument pack
+        void invoke_batch(std::span<const std::tuple<Args...>> batch) const noexcept(NoExcept) requires std::same_as<Ret, void>
+        {
+            if (manage((void*) data, &batch, internal::func_storage_op::st_invoke_batch)) return;
+            for (auto& args: batch)
+                std::apply([this](auto& ... a) { invoker((void*) data, a...); }, args);
+        }
+
+        operator bool() const noexcept { return invoker != nullptr; }
+
+        //true when the stored callable is expirable and its target is gone
+        [[nodiscard]] bool expired() const noexcept
+        {
+            return manager and manage((void*) data, nullptr, internal::func_storage_op::st_expired);
+        }
+
+#if __cpp_rtti
+        [[nodiscard]] const std::type_info& target_type() const noexcept
+        {
+            return *static_cast<const std::type_info*>(manage(nullptr, nullptr, internal::func_storage_op::st_get_type_info));
+        }
+#endif
+        //available without rtti, an empty function reports void
+        [[nodiscard]] type_id_t target_type_id() const noexcept
+        {
+            if (not manager) return type_id<void>();
+            return manage(nullptr, nullptr, internal::func_storage_op::st_get_type_id);
+        }
+
+        template<typename Callable>
+        [[nodiscard]] const Callable* target() const noexcept
+        {
+            using callable_t = Callable;
+            if (target_type_id() != type_id<callable_t>()) return nullptr;
+            //the storage reports where the callable lives, inline or in a box
+            return static_cast<const callable_t*>(manage((void*) data, nullptr, internal::func_storage_op::st_get_pointer));
+        }
+
+        //call Callable through a direct call when it is the stored callable, otherwise fall back to the invoker
+        template<typename Callable>
+        Ret invoke_as(Args... args) const noexcept(NoExcept)
+        {
+            if constexpr (storage_invocable<Callable, false>)
             {
-                T& self_ = *static_cast<T*>(self);
-                return self_(std::forward<Args>(args)...);
+                constexpr invoker_t expected = storage_invoker<Callable, false>();
+                if (invoker == expected) return expected((void*) data, std::forward<Args>(args)...);
             }
-        };
+            if constexpr (storage_invocable<Callable, true>)
+            {
+                constexpr invoker_t expected = storage_invoker<Callable, true>();
+                if (invoker == expected) return expected((void*) data, std::forward<Args>(args)...);
+            }
+            return invoker((void*) data, std::forward<Args>(args)...);
+        }
+    };
+
+    //const signature, the callable is always invoked through a const reference
+    template<typename Ret, typename... Args, bool NoExcept, size_t SOB, typename Alloc>
+    class unique_function<Ret(Args...) const noexcept(NoExcept), SOB, Alloc>
+            : public unique_function<Ret(Args...) noexcept(NoExcept), SOB, Alloc>
+    {
+        using super = unique_function<Ret(Args...) noexcept(NoExcept), SOB, Alloc>;
+    public:
+        using typename super::allocator_t;
+
+        template<typename Callable>
+        requires std::same_as<std::invoke_result_t<const std::decay_t<Callable>&, Args...>, Ret>
+                 and (not std::derived_from<std::decay_t<Callable>, super>)
+                 and std::move_constructible<std::decay_t<Callable>>
+                 and details::nothrow_invocable_if<NoExcept, const std::decay_t<Callable>&, Args...>
+        constexpr unique_function(Callable&& callable)
+                : unique_function(std::allocator_arg, allocator_t(), std::forward<Callable>(callable)) {}
 
-        template<typename T, auto ValidateMemFunc, typename Ret, typename... Args>
-        struct functor_invoker_traits
+        template<typename Callable>
+        requires std::same_as<std::invoke_result_t<const std::decay_t<Callable>&, Args...>, Ret>
+                 and (not std::derived_from<std::decay_t<Callable>, super>)
+                 and std::move_constructible<std::decay_t<Callable>>
+                 and details::nothrow_invocable_if<NoExcept, const std::decay_t<Callable>&, Args...>
+        constexpr unique_function(std::allocator_arg_t, const allocator_t& alloc, Callable&& callable)
         {
-            using invoker_t = functor_invoker_traits_validate<Ret, Args...>::invoker_t;
-            static constexpr auto invoker = functor_invoker_traits_validate<Ret, Args...>::
-            template invoker_with_validater<T, ValidateMemFunc>;
-        };
-        template<typename T, typename Ret, typename... Args>
-        struct functor_invoker_traits<T, nullptr, Ret, Args...>
+            super::template construct<true>(alloc, std::forward<Callable>(callable));
+        }
+
+        unique_function() = default;
+
+        unique_function(unique_function&& other) noexcept: super(std::move(other), std::true_type()) {}
+
+        unique_function& operator=(unique_function&& other) noexcept
         {
-            using invoker_t = functor_invoker_traits_validate<Ret, Args...>::invoker_t;
-            static constexpr auto invoker = functor_invoker_traits_trivial<Ret, Args...>::
-            template invoker<T>;
-        };
+            if (this == &other) return *this;
+            this->~unique_function();
+            ::new(this) unique_function(std::move(other));
+            return *this;
+        }
 
+        void swap(unique_function& other) noexcept { super::swap(other, std::true_type()); }
+
+        template<typename Callable>
+        requires (not std::derived_from<std::decay_t<Callable>, super>)
+        unique_function& operator=(Callable&& callable)
+        {
+            unique_function(std::forward<Callable>(callable)).swap(*this);
+            return *this;
+        }
+    };
+}
+
+namespace auto_delegate::function_v2
+{
+    struct function_validate_tag {};
+
+    namespace internal
+    {
+        enum class func_storage_op
+        {
+            st_copy,
+            st_move,
+            st_delete,
+            st_get_type_info,
+            st_get_type_id,
+            st_validate
+        };
 
         template<typename T>
         struct validator_traits;
@@ -367,7 +1084,12 @@ namespace auto_delegate::function_v2
                 typename... Args> requires std::copy_constructible<T> and std::move_constructible<T>
         struct functor_object_traits
         {
-            constexpr static auto invoker = functor_invoker_traits<T, ValidateMemFunc, Ret, Args...>::invoker;
+            //validation is a manager op, so the invoker is always a direct call
+            static Ret invoker(void* self, Args... args)
+            {
+                T& self_ = *static_cast<T*>(self);
+                return self_(std::forward<Args>(args)...);
+            }
 
             static const void* manager(void* self, void* other, func_storage_op op)
             {
@@ -388,6 +1110,14 @@ namespace auto_delegate::function_v2
                         case func_storage_op::st_get_type_info:
                             return &typeid(RTTI_T);
 #endif
+                    case func_storage_op::st_get_type_id:
+                        return type_id<RTTI_T>();
+                    case func_storage_op::st_validate:
+                        //non null when valid
+                        if constexpr (ValidateMemFunc != nullptr)
+                            return (self_.*ValidateMemFunc)(function_validate_tag{}) ? self : nullptr;
+                        else
+                            return self;
                 }
                 return nullptr;
             }
@@ -396,25 +1126,45 @@ namespace auto_delegate::function_v2
                     std::is_trivially_copyable_v<T>
                     and std::is_trivially_move_constructible_v<T>
                     and std::is_trivially_destructible_v<T>;
+
+            static constexpr bool is_relocatable = is_trivially_relocatable_v<T>;
         };
 
 
-        template<typename Callable, typename Ret, typename... Args>
+        template<typename Callable, typename Alloc, typename Ret, typename... Args>
         struct functor_box_wrapper
         {
+            using allocator_t = typename std::allocator_traits<Alloc>::template rebind_alloc<Callable>;
+            using allocator_traits_t = std::allocator_traits<allocator_t>;
+
             Callable* callee;
+            [[FUNCTION_no_unique_address]] allocator_t allocator;
+
+            //only the pointer and the allocator live in the small buffer
+            static constexpr bool is_trivially_relocatable = is_trivially_relocatable_v<allocator_t>;
 
             template<typename Other>
-            explicit functor_box_wrapper(Other&& callee)
-                    : callee(new Callable(std::forward<Other>(callee))) {}
+            explicit functor_box_wrapper(const Alloc& alloc, Other&& callee)
+                    : callee(), allocator(alloc)
+            {
+                this->callee = create(std::forward<Other>(callee));
+            }
 
             functor_box_wrapper(const functor_box_wrapper& other)
-                    : callee(new Callable(*other.callee)) {}
+                    : callee(), allocator(other.allocator)
+            {
+                callee = create(*other.callee);
+            }
 
             functor_box_wrapper(functor_box_wrapper&& other)
-                    : callee(other.callee) { other.callee = nullptr; }
+                    : callee(other.callee), allocator(other.allocator) { other.callee = nullptr; }
 
-            ~functor_box_wrapper() { delete callee; }
+            ~functor_box_wrapper()
+            {
+                if (not callee) return;
+                allocator_traits_t::destroy(allocator, callee);
+                allocator_traits_t::deallocate(allocator, callee, 1);
+            }
 
             Ret operator()(Args... args)
             {
@@ -427,30 +1177,48 @@ namespace auto_delegate::function_v2
             }
 
             const Callable* get() const noexcept { return callee; }
+
+        private:
+            template<typename Other>
+            Callable* create(Other&& other)
+            {
+                Callable* p = allocator_traits_t::allocate(allocator, 1);
+                try
+                {
+                    allocator_traits_t::construct(allocator, p, std::forward<Other>(other));
+                } catch (...)
+                {
+                    allocator_traits_t::deallocate(allocator, p, 1);
+                    throw;
+                }
+                return p;
+            }
         };
     }
 
-    template<typename FuncT, size_t SOB = 48>
+    template<typename FuncT, size_t SOB = 48, typename Alloc = std::allocator<std::byte>>
     struct function;
 
     template<typename Callable>
     function(Callable&&) -> function<typename details::function_traits<std::decay_t<Callable>>::decay_function_type>;
 
-    template<typename Ret, typename... Args, size_t SOB>
-    class function<Ret(Args...), SOB>
+    template<typename Ret, typename... Args, size_t SOB, typename Alloc>
+    class function<Ret(Args...), SOB, Alloc>
     {
+    public:
+        using allocator_t = Alloc;
     protected:
-        using invoker_t = internal::functor_invoker_traits_validate<Ret, Args...>::invoker_t;
-        using trivial_invoker_t = Ret(*)(void*, Args...);
+        using invoker_t = Ret (*)(void*, Args...);
         using manager_t = const void* (*)(void*, void*, internal::func_storage_op);
 
         alignas(std::max_align_t) void* data[SOB / sizeof(void*)];
-        void* invoker;
+        invoker_t invoker;
         manager_t manager;
         static constexpr size_t inline_storage_size = sizeof(data);
         static constexpr uintptr_t non_trivial_bit_mask = uintptr_t(1) << (sizeof (uintptr_t) * 8 - 1);
         static constexpr uintptr_t validator_bit_mask = non_trivial_bit_mask >> 1;
-        static constexpr uintptr_t tag_mask = non_trivial_bit_mask | validator_bit_mask;
+        static constexpr uintptr_t relocatable_bit_mask = validator_bit_mask >> 1;
+        static constexpr uintptr_t tag_mask = non_trivial_bit_mask | validator_bit_mask | relocatable_bit_mask;
         static constexpr uintptr_t pointer_mask = ~(tag_mask);
 
         [[nodiscard]] bool non_trivial() const
@@ -458,6 +1226,12 @@ namespace auto_delegate::function_v2
             return uintptr_t(manager) & non_trivial_bit_mask;
         }
 
+        //trivial or trivially relocatable, the storage can be moved by memcpy
+        [[nodiscard]] bool relocatable() const
+        {
+            return (uintptr_t(manager) & (non_trivial_bit_mask | relocatable_bit_mask)) != non_trivial_bit_mask;
+        }
+
         [[nodiscard]] bool has_validator() const
         {
             return uintptr_t(manager) & validator_bit_mask;
@@ -469,12 +1243,13 @@ namespace auto_delegate::function_v2
             return m(self, other, op);
         }
 
-        void set_manager_and_tags(manager_t m, bool trivial, bool has_validator)
+        void set_manager_and_tags(manager_t m, bool trivial, bool has_validator, bool relocatable)
         {
             uintptr_t& ptr = *(uintptr_t*) &m;
             assert((ptr & tag_mask) == 0);
             if (not trivial) ptr |= non_trivial_bit_mask;
             if (has_validator) ptr |= validator_bit_mask;
+            if (relocatable) ptr |= relocatable_bit_mask;
             manager = manager_t(ptr);
 
         }
@@ -486,8 +1261,18 @@ namespace auto_delegate::function_v2
                  and std::move_constructible<Callable>
                  and std::copy_constructible<Callable>
         function(Callable&& callable)
+                : function(std::allocator_arg, allocator_t(), std::forward<Callable>(callable)) {}
+
+        //the allocator is only used when the callable does not fit in the small buffer
+        template<typename Callable>
+        requires std::same_as<std::invoke_result_t<Callable, Args...>, Ret>
+                 and (not std::same_as<std::decay_t<Callable>, function>)
+                 and std::move_constructible<Callable>
+                 and std::copy_constructible<Callable>
+        function(std::allocator_arg_t, const allocator_t& alloc, Callable&& callable)
         {
             using callable_t = std::decay_t<Callable>;
+            telemetry::internal::record_construction<function, callable_t, inline_storage_size>();
 
             if constexpr (sizeof(callable_t) <= inline_storage_size)
             {
@@ -500,11 +1285,12 @@ namespace auto_delegate::function_v2
                         validator,
                         Ret, Args...>;
                 ::new(data) inline_functor_t(std::forward<Callable>(callable));
-                invoker = (void*) (traits::invoker);
-                set_manager_and_tags(traits::manager, traits::is_trivial, has_validator);
+                invoker = traits::invoker;
+                set_manager_and_tags(traits::manager, traits::is_trivial, has_validator, traits::is_relocatable);
             } else
             {
-                using inline_functor_t = internal::functor_box_wrapper<callable_t, Ret, Args...>;
+                using inline_functor_t = internal::functor_box_wrapper<callable_t, Alloc, Ret, Args...>;
+                static_assert(sizeof(inline_functor_t) <= inline_storage_size, "allocator is too large for the small buffer");
                 constexpr auto validator = internal::validator_traits<inline_functor_t>::validator;
                 constexpr bool has_validator = internal::validator_traits<inline_functor_t>::has_validator;
                 using traits = internal::functor_object_traits<
@@ -512,9 +1298,9 @@ namespace auto_delegate::function_v2
                         callable_t,
                         validator,
                         Ret, Args...>;
-                ::new(data) inline_functor_t(std::forward<Callable>(callable));
-                invoker = (void*) (traits::invoker);
-                set_manager_and_tags(traits::manager, false, has_validator);
+                ::new(data) inline_functor_t(alloc, std::forward<Callable>(callable));
+                invoker = traits::invoker;
+                set_manager_and_tags(traits::manager, false, has_validator, traits::is_relocatable);
             }
         }
 
@@ -522,14 +1308,16 @@ namespace auto_delegate::function_v2
 
         function(const function& other) : invoker(other.invoker), manager(other.manager)
         {
+            telemetry::internal::record_copy<function>();
             if (non_trivial()) manage(data, (void*) other.data, internal::func_storage_op::st_copy);
             else std::memcpy(data, other.data, sizeof(data));
         }
 
         function(function&& other) noexcept: invoker(other.invoker), manager(other.manager)
         {
-            if (non_trivial()) manage(data, other.data, internal::func_storage_op::st_move);
-            else std::memcpy(data, other.data, sizeof(data));
+            telemetry::internal::record_move<function>();
+            if (relocatable()) std::memcpy(data, other.data, sizeof(data));
+            else manage(data, other.data, internal::func_storage_op::st_move);
             other.invoker = nullptr;
             other.manager = nullptr;
         }
@@ -541,6 +1329,14 @@ namespace auto_delegate::function_v2
 
         void swap(function& other) noexcept
         {
+            if (relocatable() and other.relocatable())
+            {
+                alignas(function) std::byte temp[sizeof(function)];
+                std::memcpy(temp, (void*) this, sizeof(function));
+                std::memcpy((void*) this, (void*) &other, sizeof(function));
+                std::memcpy((void*) &other, temp, sizeof(function));
+                return;
+            }
             function temp = std::move(other);
             ::new(&other) function(std::move(*this));
             ::new(this) function(std::move(temp));
@@ -552,9 +1348,12 @@ namespace auto_delegate::function_v2
             return *this;
         }
 
-        function& operator=(function&& other)
+        function& operator=(function&& other) noexcept
         {
-            function(std::move(other)).swap(*this);
+            //move in place, a relocatable callable is moved by memcpy
+            if (this == &other) return *this;
+            this->~function();
+            ::new(this) function(std::move(other));
             return *this;
         }
 
@@ -570,21 +1369,7 @@ namespace auto_delegate::function_v2
 
         [[nodiscard]] bool validater_() const
         {
-            return reinterpret_cast<invoker_t>(invoker)(internal::func_invoke_op::validate, (void*) data, nullptr).valid;
-        }
-
-        Ret invoke_(std::tuple<Args...> args_tuple) const
-        {
-            if constexpr (std::is_void_v<Ret>)
-                reinterpret_cast<invoker_t>(invoker)(internal::func_invoke_op::invoke, (void*) data, &args_tuple);
-            else
-                return reinterpret_cast<invoker_t>(invoker)(internal::func_invoke_op::invoke, (void*) data, &args_tuple).ret;
-        }
-
-        Ret invoke_trivial_(Args... args) const
-        {
-            return reinterpret_cast<trivial_invoker_t>(invoker)((void*) data, std::forward<Args>(args)...);
-
+            return manage((void*) data, nullptr, internal::func_storage_op::st_validate) != nullptr;
         }
 
     public:
@@ -600,22 +1385,15 @@ namespace auto_delegate::function_v2
         Ret operator()(Args... args) const
         {
             assert(invoker);
-            if (has_validator())
-                return invoke_({std::forward<Args>(args)...});
-            else
-                return invoke_trivial_(args...);
+            return invoker((void*) data, std::forward<Args>(args)...);
         }
 
         std::optional<Ret> try_invoke(Args... args)
         {
             assert(invoker);
-            if (has_validator())
-                if (validater_())
-                    return invoke_({std::forward<Args>(args)...});
-                else
-                    return std::nullopt;
-            else
-                return invoke_trivial_(args...);
+            if (has_validator() and not validater_())
+                return std::nullopt;
+            return invoker((void*) data, std::forward<Args>(args)...);
         }
 
         operator bool() const noexcept { return invoker != nullptr; }
@@ -625,27 +1403,58 @@ namespace auto_delegate::function_v2
         {
             return *static_cast<const std::type_info*>(manage(nullptr, nullptr, internal::func_storage_op::st_get_type_info));
         }
+#endif
+        //available without rtti, an empty function reports void
+        [[nodiscard]] type_id_t target_type_id() const noexcept
+        {
+            if (not manager) return type_id<void>();
+            return manage(nullptr, nullptr, internal::func_storage_op::st_get_type_id);
+        }
+
         template<typename Callable>
         [[nodiscard]] const Callable* target() const noexcept
         {
             using callable_t = Callable;
-            if(typeid(callable_t) != target_type()) return nullptr;
+            if (target_type_id() != type_id<callable_t>()) return nullptr;
             if constexpr (sizeof(callable_t) <= inline_storage_size)
             {
                 using inline_functor_t = callable_t;
-                return static_cast<const inline_functor_t*>(data);
+                return static_cast<const inline_functor_t*>((const void*) data);
             }
             else
             {
-                using inline_functor_t = internal::functor_box_wrapper<callable_t, Ret, Args...>;
-                return static_cast<const inline_functor_t*>(data)->get();
+                using inline_functor_t = internal::functor_box_wrapper<callable_t, Alloc, Ret, Args...>;
+                return static_cast<const inline_functor_t*>((const void*) data)->get();
             }
         }
-#endif
     };
 }
 
+namespace auto_delegate::function_v1::pmr
+{
+    template<typename FuncT, size_t SOB = 48>
+    using function = function_v1::function<FuncT, SOB, std::pmr::polymorphic_allocator<std::byte>>;
+
+    template<typename FuncT, size_t SOB = 48>
+    using unique_function = function_v1::unique_function<FuncT, SOB, std::pmr::polymorphic_allocator<std::byte>>;
+}
+
+namespace auto_delegate::function_v2::pmr
+{
+    template<typename FuncT, size_t SOB = 48>
+    using function = function_v2::function<FuncT, SOB, std::pmr::polymorphic_allocator<std::byte>>;
+}
+
 namespace auto_delegate
 {
     using function_v1::function;
-}
\ No newline at end of file
+    using function_v1::unique_function;
+
+    namespace pmr
+    {
+        using function_v1::pmr::function;
+        using function_v1::pmr::unique_function;
+    }
+}
+
+#undef FUNCTION_no_unique_address
\ No newline at end of file
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <concepts>
+#include <type_traits>
+#include <memory>
+#include "function_traits.h"
+#include "delegate.h"
+#include "function.h"
+
+namespace auto_delegate
+{
+    namespace details
+    {
+        //types whose invoker can be referenced directly without an extra indirection
+        template<typename T, typename FuncT>
+        struct function_ref_direct : std::false_type {};
+
+        template<typename Ret, typename... Args, bool NoExcept, size_t SOB, typename Alloc>
+        struct function_ref_direct<
+                function_v1::function<Ret(Args...) noexcept(NoExcept), SOB, Alloc>,
+                Ret(Args...) noexcept(NoExcept)> : std::true_type {};
+
+        template<typename Ret, typename... Args, bool NoExcept, size_t SOB, typename Alloc>
+        struct function_ref_direct<
+                function_v1::unique_function<Ret(Args...) noexcept(NoExcept), SOB, Alloc>,
+                Ret(Args...) noexcept(NoExcept)> : std::true_type {};
+
+        template<typename Ret, typename... Args, bool NoExcept>
+        struct function_ref_direct<
+                delegate<Ret(Args...) noexcept(NoExcept), void*>,
+                Ret(Args...) noexcept(NoExcept)> : std::true_type {};
+
+        template<typename Ret, typename... Args, bool NoExcept, size_t SOB, typename Alloc>
+        struct function_ref_direct<
+                function_v1::function<Ret(Args...) const noexcept(NoExcept), SOB, Alloc>,
+                Ret(Args...) const noexcept(NoExcept)> : std::true_type {};
+
+        template<typename Ret, typename... Args, bool NoExcept, size_t SOB, typename Alloc>
+        struct function_ref_direct<
+                function_v1::unique_function<Ret(Args...) const noexcept(NoExcept), SOB, Alloc>,
+                Ret(Args...) const noexcept(NoExcept)> : std::true_type {};
+    }
+
+    //non-owning view of a callable, the referenced callable must outlive the function_ref
+    template<typename FuncT>
+    class function_ref;
+
+    template<typename Callable>
+    function_ref(Callable&&) -> function_ref<typename details::function_traits<std::decay_t<Callable>>::decay_function_type>;
+
+    template<typename Ret, typename... Args, bool NoExcept>
+    class function_ref<Ret(Args...) noexcept(NoExcept)>
+    {
+    protected:
+        template<typename T>
+        static Ret CallableInvoker(void* obj, Args... args) noexcept(NoExcept)
+        {
+            return (*static_cast<T*>(obj))(std::forward<Args>(args)...);
+        }
+
+        template<typename T, auto MemFunc>
+        static Ret Invoker(void* obj, Args... args) noexcept(NoExcept)
+        {
+            return (static_cast<T*>(obj)->*MemFunc)(std::forward<Args>(args)...);
+        }
+
+        template<auto Callable>
+        static Ret StaticInvoker(void*, Args... args) noexcept(NoExcept)
+        {
+            return Callable(std::forward<Args>(args)...);
+        }
+
+        static Ret FunctionPointerInvoker(void* func, Args... args) noexcept(NoExcept)
+        {
+            return reinterpret_cast<Ret (*)(Args...) noexcept(NoExcept)>(func)(std::forward<Args>(args)...);
+        }
+
+        using invoker_t = Ret (*)(void*, Args...) noexcept(NoExcept);
+
+        void* ptr;
+        invoker_t invoker;
+
+        function_ref(void* ptr, invoker_t invoker) noexcept : ptr(ptr), invoker(invoker) {}
+
+    public:
+        using function_type = Ret(Args...) noexcept(NoExcept);
+        using function_pointer = Ret(*)(Args...) noexcept(NoExcept);
+
+        //reference a callable object, the lifetime of the callable is not extended
+        template<typename Callable>
+        requires std::same_as<std::invoke_result_t<Callable&, Args...>, Ret>
+                 and (not std::derived_from<std::remove_cvref_t<Callable>, function_ref>)
+                 and details::nothrow_invocable_if<NoExcept, Callable&, Args...>
+                 and (not details::function_ref_direct<std::remove_cvref_t<Callable>, Ret(Args...) noexcept(NoExcept)>::value)
+                 and (not std::is_function_v<std::remove_pointer_t<std::decay_t<Callable>>>)
+        function_ref(Callable&& callable) noexcept
+                : ptr((void*) std::addressof(callable)),
+                  invoker(CallableInvoker<std::remove_reference_t<Callable>>) {}
+
+        //the invoker of function is called directly on its storage
+        template<size_t SOB, typename Alloc>
+        function_ref(const function_v1::function<Ret(Args...) noexcept(NoExcept), SOB, Alloc>& func) noexcept
+                : ptr((void*) func.data), invoker(func.invoker) {}
+
+        template<size_t SOB, typename Alloc>
+        function_ref(const function_v1::unique_function<Ret(Args...) noexcept(NoExcept), SOB, Alloc>& func) noexcept
+                : ptr((void*) func.data), invoker(func.invoker) {}
+
+        //the invoker of a raw pointer delegate is reused
+        function_ref(const delegate<Ret(Args...) noexcept(NoExcept), void*>& d) noexcept
+                : ptr(d.ptr), invoker(d.invoker) {}
+
+        function_ref(function_pointer func) noexcept
+                : ptr((void*) func), invoker(FunctionPointerInvoker)
+        {
+            assert(func);
+        }
+
+        //bind static function
+        template<auto StaticFunc>
+        requires details::nothrow_invocable_if<NoExcept, decltype(StaticFunc), Args...>
+        function_ref(func_tag<StaticFunc>) noexcept
+                : ptr(nullptr), invoker(StaticInvoker<StaticFunc>) {}
+
+        //bind methods
+        template<auto MemFunc, typename T>
+        requires details::nothrow_invocable_if<NoExcept, decltype(MemFunc), T&, Args...>
+        function_ref(T* obj, func_tag<MemFunc>) noexcept
+                : ptr((void*) obj), invoker(Invoker<T, MemFunc>) {}
+
+        function_ref(const function_ref&) = default;
+
+        function_ref& operator=(const function_ref&) = default;
+
+        Ret operator()(Args... args) const noexcept(NoExcept)
+        {
+            return invoker(ptr, std::forward<Args>(args)...);
+        }
+    };
+
+    //const signature, the referenced callable is invoked through a const reference
+    template<typename Ret, typename... Args, bool NoExcept>
+    class function_ref<Ret(Args...) const noexcept(NoExcept)> : public function_ref<Ret(Args...) noexcept(NoExcept)>
+    {
+        using super = function_ref<Ret(Args...) noexcept(NoExcept)>;
+    public:
+        using typename super::function_pointer;
+
+        template<typename Callable>
+        requires std::same_as<std::invoke_result_t<const std::remove_reference_t<Callable>&, Args...>, Ret>
+                 and (not std::derived_from<std::remove_cvref_t<Callable>, super>)
+                 and details::nothrow_invocable_if<NoExcept, const std::remove_reference_t<Callable>&, Args...>
+                 and (not details::function_ref_direct<std::remove_cvref_t<Callable>, Ret(Args...) const noexcept(NoExcept)>::value)
+                 and (not std::is_function_v<std::remove_pointer_t<std::decay_t<Callable>>>)
+        function_ref(Callable&& callable) noexcept
+                : super((void*) std::addressof(callable),
+                        super::template CallableInvoker<const std::remove_reference_t<Callable>>) {}
+
+        //the const function already holds a const invoker
+        template<size_t SOB, typename Alloc>
+        function_ref(const function_v1::function<Ret(Args...) const noexcept(NoExcept), SOB, Alloc>& func) noexcept
+                : super(static_cast<const function_v1::function<Ret(Args...) noexcept(NoExcept), SOB, Alloc>&>(func)) {}
+
+        template<size_t SOB, typename Alloc>
+        function_ref(const function_v1::unique_function<Ret(Args...) const noexcept(NoExcept), SOB, Alloc>& func) noexcept
+                : super(static_cast<const function_v1::unique_function<Ret(Args...) noexcept(NoExcept), SOB, Alloc>&>(func)) {}
+
+        function_ref(function_pointer func) noexcept : super(func) {}
+
+        template<auto StaticFunc>
+        requires details::nothrow_invocable_if<NoExcept, decltype(StaticFunc), Args...>
+        function_ref(func_tag<StaticFunc> tag) noexcept : super(tag) {}
+
+        //bind const methods
+        template<auto MemFunc, typename T>
+        requires details::nothrow_invocable_if<NoExcept, decltype(MemFunc), const T&, Args...>
+        function_ref(const T* obj, func_tag<MemFunc>) noexcept
+                : super((void*) obj, super::template Invoker<const T, MemFunc>) {}
+    };
+}
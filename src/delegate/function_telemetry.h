@@ -0,0 +1,144 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+//define AUTO_DELEGATE_FUNCTION_TELEMETRY to count the small buffer usage of function
+//every translation unit of a program must agree on the definition
+namespace auto_delegate::telemetry
+{
+#ifdef AUTO_DELEGATE_FUNCTION_TELEMETRY
+    constexpr bool enabled = true;
+#else
+    constexpr bool enabled = false;
+#endif
+
+    //readable type name without rtti
+    template<typename T>
+    constexpr std::string_view type_name()
+    {
+#if defined _MSC_VER
+        std::string_view name = __FUNCSIG__;
+        std::string_view prefix = "type_name<";
+        std::string_view suffix = ">(void)";
+        size_t begin = name.find(prefix) + prefix.size();
+        size_t end = name.rfind(suffix);
+#else
+        std::string_view name = __PRETTY_FUNCTION__;
+        std::string_view prefix = "T = ";
+        size_t begin = name.find(prefix) + prefix.size();
+        size_t end = name.find_first_of(";]", begin);
+#endif
+        return name.substr(begin, end - begin);
+    }
+
+    struct function_counters
+    {
+        std::atomic<uint64_t> inline_constructions{0};
+        std::atomic<uint64_t> boxed_constructions{0};
+        std::atomic<uint64_t> shared_constructions{0};
+        std::atomic<uint64_t> copies{0};
+        std::atomic<uint64_t> moves{0};
+    };
+
+    //counters of one function type, linked into a global list on first use
+    //the type carries the qualified signature, the small buffer size and the allocator, each is counted apart
+    struct signature_counters : function_counters
+    {
+        std::string_view signature;
+        signature_counters* next;
+
+        inline static std::atomic<signature_counters*> head{nullptr};
+
+        explicit signature_counters(std::string_view signature) : signature(signature), next(nullptr)
+        {
+            next = head.load(std::memory_order_relaxed);
+            while (not head.compare_exchange_weak(next, this, std::memory_order_release, std::memory_order_relaxed));
+        }
+
+        signature_counters(const signature_counters&) = delete;
+    };
+
+    //FuncT is the function type itself, e.g. function<void(int) const, 64>
+    //a local static, so a function built during the static initialization of another translation unit still finds them constructed
+    template<typename FuncT>
+    signature_counters& counters_of()
+    {
+        static signature_counters counters{type_name<FuncT>()};
+        return counters;
+    }
+
+    template<typename Fn>
+    void for_each_signature(Fn&& fn)
+    {
+        for (auto p = signature_counters::head.load(std::memory_order_acquire); p; p = p->next)
+            fn(static_cast<const signature_counters&>(*p));
+    }
+
+    //reported every time a callable does not fit in the small buffer
+    struct overflow_info
+    {
+        std::string_view signature;
+        std::string_view callable_type;
+        size_t callable_size;
+        size_t callable_align;
+        size_t inline_storage_size;
+    };
+
+    using overflow_handler_t = void (*)(const overflow_info&);
+
+    inline std::atomic<overflow_handler_t> overflow_handler{nullptr};
+
+    inline overflow_handler_t set_overflow_handler(overflow_handler_t handler)
+    {
+        return overflow_handler.exchange(handler, std::memory_order_acq_rel);
+    }
+
+    namespace internal
+    {
+        template<typename FuncT, typename Callable, size_t InlineStorageSize>
+        void record_construction()
+        {
+            if constexpr (enabled)
+            {
+                if constexpr (sizeof(Callable) <= InlineStorageSize)
+                    counters_of<FuncT>().inline_constructions.fetch_add(1, std::memory_order_relaxed);
+                else
+                {
+                    counters_of<FuncT>().boxed_constructions.fetch_add(1, std::memory_order_relaxed);
+                    if (auto handler = overflow_handler.load(std::memory_order_acquire))
+                        handler(overflow_info{
+                                type_name<FuncT>(),
+                                type_name<Callable>(),
+                                sizeof(Callable),
+                                alignof(Callable),
+                                InlineStorageSize});
+                }
+            }
+        }
+
+        //shared boxes are requested explicitly, they are not reported as overflow
+        template<typename FuncT>
+        void record_shared_construction()
+        {
+            if constexpr (enabled)
+                counters_of<FuncT>().shared_constructions.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        template<typename FuncT>
+        void record_copy()
+        {
+            if constexpr (enabled)
+                counters_of<FuncT>().copies.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        template<typename FuncT>
+        void record_move()
+        {
+            if constexpr (enabled)
+                counters_of<FuncT>().moves.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
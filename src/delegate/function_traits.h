@@ -1,5 +1,6 @@
 #pragma once
 #include <tuple>
+#include <type_traits>
 
 namespace auto_delegate
 {
@@ -86,6 +87,10 @@ namespace auto_delegate
         // callable object
         template<typename Callable> requires requires { &Callable::operator(); }
         struct function_traits<Callable> : function_traits<decltype(&Callable::operator())> {};
+
+        //a noexcept signature only accepts targets that can not throw
+        template<bool NoExcept, typename Callable, typename... Args>
+        concept nothrow_invocable_if = (not NoExcept) or std::is_nothrow_invocable_v<Callable, Args...>;
     }
 }
 
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "parallel_invoke.h"
+
+namespace auto_delegate
+{
+    class mailbox;
+
+    namespace details
+    {
+        //shared by a listener and the calls posted to it, the last owner deletes it
+        //alive is only touched by the thread draining the mailbox, which is also the one destroying the listener
+        struct affinity_token
+        {
+            std::atomic<uint32_t> refs{1};
+            bool alive = true;
+            mailbox* box;
+
+            explicit affinity_token(mailbox& box) : box(&box) {}
+
+            void acquire() noexcept { refs.fetch_add(1, std::memory_order_relaxed); }
+
+            void release() noexcept
+            {
+                if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) delete this;
+            }
+        };
+
+        struct mail
+        {
+            mail* next = nullptr;
+            affinity_token* token;
+            void* obj;
+            //calls the listener when alive is set, then frees the mail
+            void (* deliver)(mail* self, bool alive);
+        };
+
+        //a noexcept event only posts arguments whose stored copy can not throw
+        template<bool NoExcept, typename... Args>
+        concept nothrow_postable_if = (not NoExcept) or (std::is_nothrow_constructible_v<std::remove_cvref_t<Args>, Args> and ...);
+
+        //the arguments are stored by value, a reference parameter refers to the posted copy
+        template<typename T, auto MemFunc, typename... Args>
+        struct posted_call : mail
+        {
+            std::tuple<std::remove_cvref_t<Args>...> args;
+
+            template<typename... U>
+            posted_call(affinity_token* token, void* obj, U&& ... args)
+                    : mail{nullptr, token, obj, &deliver_call}, args(std::forward<U>(args)...) {}
+
+            static void deliver_call(mail* self, bool alive)
+            {
+                auto* call = static_cast<posted_call*>(self);
+                struct free_call
+                {
+                    posted_call* call;
+
+                    ~free_call()
+                    {
+                        call->token->release();
+                        delete call;
+                    }
+                } guard{call};
+                if (alive)
+                    std::apply([&](auto& ... a) { (reinterpret_cast<T*>(call->obj)->*MemFunc)(std::forward<Args>(a)...); }, call->args);
+            }
+        };
+    }
+
+    //lock free multi producer single consumer queue of calls posted to the listeners of one thread
+    //any thread posts, only the owning thread drains
+    class mailbox
+    {
+        alignas(details::cache_line_size) std::atomic<details::mail*> head{nullptr};
+
+    public:
+        mailbox() = default;
+
+        mailbox(const mailbox&) = delete;
+
+        mailbox& operator=(const mailbox&) = delete;
+
+        //the listeners of the mailbox are expected to be gone, the pending calls are dropped
+        ~mailbox() { discard(); }
+
+        void post(details::mail* m) noexcept
+        {
+            m->next = head.load(std::memory_order_relaxed);
+            while (!head.compare_exchange_weak(m->next, m, std::memory_order_release, std::memory_order_relaxed));
+        }
+
+        bool empty() const noexcept { return head.load(std::memory_order_relaxed) == nullptr; }
+
+        //takes every pending call at once and delivers them in posting order
+        //calls posted meanwhile wait for the next drain, calls to listeners destroyed since the post are skipped
+        //returns the number of calls taken, skipped ones included
+        size_t drain()
+        {
+            details::mail* batch = take();
+            size_t count = 0;
+            //if a listener throws, the rest of the batch is dropped
+            struct drop_rest
+            {
+                details::mail*& rest;
+
+                ~drop_rest()
+                {
+                    while (rest)
+                    {
+                        auto* m = std::exchange(rest, rest->next);
+                        m->deliver(m, false);
+                    }
+                }
+            } guard{batch};
+            while (batch)
+            {
+                auto* m = std::exchange(batch, batch->next);
+                m->deliver(m, m->token->alive);
+                ++count;
+            }
+            return count;
+        }
+
+        void discard() noexcept
+        {
+            details::mail* batch = take();
+            while (batch)
+            {
+                auto* m = std::exchange(batch, batch->next);
+                m->deliver(m, false);
+            }
+        }
+
+    private:
+        //detaches the pending calls, reversed from the push order of the stack into posting order
+        details::mail* take() noexcept
+        {
+            details::mail* m = head.exchange(nullptr, std::memory_order_acquire);
+            details::mail* ordered = nullptr;
+            while (m)
+            {
+                details::mail* next = m->next;
+                m->next = ordered;
+                ordered = m;
+                m = next;
+            }
+            return ordered;
+        }
+    };
+
+    //base of a listener owned by one thread, bind it with bind_posted to have its calls delivered by mailbox::drain
+    //the listener has to be destroyed by the draining thread, and not while an invoke is posting to it
+    class mailbox_affinity
+    {
+        details::affinity_token* token;
+
+    public:
+        explicit mailbox_affinity(mailbox& box) : token(new details::affinity_token(box)) {}
+
+        mailbox_affinity(const mailbox_affinity&) = delete;
+
+        mailbox_affinity& operator=(const mailbox_affinity&) = delete;
+
+        ~mailbox_affinity()
+        {
+            token->alive = false;
+            token->release();
+        }
+
+        mailbox& affinity() const noexcept { return *token->box; }
+
+        //Args are the parameters of the event, given explicitly
+        template<typename T, auto MemFunc, typename... Args>
+        void post(void* obj, Args... args)
+        {
+            token->acquire();
+            token->box->post(new details::posted_call<T, MemFunc, Args...>(token, obj, std::forward<Args>(args)...));
+        }
+    };
+}
@@ -1,9 +1,20 @@
 #pragma once
 
 #include <memory>
+#include <algorithm>
+#include <functional>
 #include <cassert>
 #include <vector>
+#include <iterator>
+#include <utility>
+#include <span>
+#include <tuple>
+#include <cstdint>
 #include "delegate.h"
+#include "parallel_invoke.h"
+#include "combiner.h"
+#include "prefetch.h"
+#include "mailbox.h"
 
 #ifdef no_unique_address
 #undef no_unique_address
@@ -228,7 +239,67 @@ namespace auto_delegate
 
 #pragma endregion
 
-    template<typename = void>
+    //unbind moves the last listener into the removed place, listener order is not kept
+    struct swap_back_removal {};
+
+    //unbind leaves a tombstone skipped by invokes, listeners are called in bind order
+    //tombstones are compacted in one pass once they make up 1 / CompactionRatio of the container
+    template<size_t CompactionRatio = 4>
+    struct ordered_removal
+    {
+        static_assert(CompactionRatio > 0);
+        static constexpr size_t compaction_ratio = CompactionRatio;
+    };
+
+    namespace details
+    {
+        template<typename RemovalPolicy>
+        constexpr bool is_ordered_removal = false;
+
+        template<size_t CompactionRatio>
+        constexpr bool is_ordered_removal<ordered_removal<CompactionRatio>> = true;
+
+        //walks the listeners of an ordered container, skipping the tombstones left by unbind
+        template<typename Object>
+        class tombstone_skip_iterator
+        {
+            Object* it;
+            Object* last;
+
+            void skip() { while (it != last and it->mem_fn == nullptr) ++it; }
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using difference_type = std::ptrdiff_t;
+            using value_type = Object;
+            using pointer = Object*;
+            using reference = Object&;
+
+            tombstone_skip_iterator() : it(), last() {}
+
+            tombstone_skip_iterator(Object* it, Object* last) : it(it), last(last) { skip(); }
+
+            Object& operator*() const { return *it; }
+
+            tombstone_skip_iterator& operator++()
+            {
+                ++it;
+                skip();
+                return *this;
+            }
+
+            tombstone_skip_iterator operator++(int)
+            {
+                auto copy = *this;
+                operator++();
+                return copy;
+            }
+
+            bool operator==(const tombstone_skip_iterator& other) const { return it == other.it; }
+        };
+    }
+
+    template<typename RemovalPolicy = swap_back_removal>
     class default_delegate_container
     {
     public:
@@ -238,21 +309,23 @@ namespace auto_delegate
         using inverse_handle_t = typename delegate_handle_traits<delegate_handle_t>::inverse_handle_type;
         using inverse_handle_t_ref = typename delegate_handle_traits<delegate_handle_t>::inverse_handle_reference;
         static constexpr bool enable_delegate_handle = delegate_handle_traits<delegate_handle_t>::enable_delegate_handle;
+        static constexpr bool ordered = details::is_ordered_removal<RemovalPolicy>;
 
     private:
         struct delegate_object
         {
             void* ptr;
-            void* mem_fn;
+            void* mem_fn;//null for a tombstone
             [[DELEGATE_no_unique_address]] inverse_handle_t inv_handle;
         };
 
         std::vector<delegate_object> objects;
+        size_t tombstones = 0;
     public:
         default_delegate_container() = default;
         default_delegate_container(const default_delegate_container&) = delete;
         default_delegate_container(default_delegate_container&& other) noexcept
-        :objects( std::move(other.objects) ) {
+        :objects( std::move(other.objects) ), tombstones(std::exchange(other.tombstones, 0)) {
             if constexpr (enable_delegate_handle)
                 if constexpr (delegate_handle_t::container_reference)
                 {
@@ -263,11 +336,15 @@ namespace auto_delegate
                 }
         }
 
-        auto size() { return objects.size(); }
+        auto size() { return objects.size() - tombstones; }
 
-        bool empty() { return objects.empty(); }
+        bool empty() { return size() == 0; }
 
-        void clear() { objects.clear(); }
+        void clear()
+        {
+            objects.clear();
+            tombstones = 0;
+        }
 
         delegate_handle_t bind(void* obj, void* invoker)
         {
@@ -281,13 +358,24 @@ namespace auto_delegate
         }
 
     private:
+        void remove_at(size_t index)
+        {
+            if constexpr (ordered)
+            {
+                objects[index] = delegate_object{nullptr, nullptr, inverse_handle_t{}};
+                if (++tombstones * RemovalPolicy::compaction_ratio >= objects.size()) compact();
+            } else
+            {
+                objects[index] = std::move(objects.back());
+                objects.pop_back();
+            }
+        }
+
         void unbind_(delegate_handle_ref* inv_handle)
         {
             intptr_t handle_ref_element_offset = offsetof(delegate_object, inv_handle);
             auto* o = (delegate_object*) (intptr_t(inv_handle) - handle_ref_element_offset);
-            int64_t index = o - objects.data();
-            objects[index] = std::move(objects.back());
-            objects.pop_back();
+            remove_at(o - objects.data());
         }
     public:
         void unbind(delegate_handle_t_ref handle) requires enable_delegate_handle
@@ -302,55 +390,739 @@ namespace auto_delegate
         {
             for (int i = 0; i < objects.size(); ++i)
             {
-                if (objects[i].ptr == obj)
+                if (objects[i].ptr == obj and objects[i].mem_fn)
                 {
-                    objects[i] = std::move(objects.back());
-                    objects.pop_back();
+                    remove_at(i);
                     return;
                 }
             }
             assert(false);
         }
 
-        using iterator = std::vector<delegate_object>::iterator;
+        //drops the tombstones in one pass, handle references follow the moved objects
+        void compact()
+        {
+            std::erase_if(objects, [](const delegate_object& o) { return o.mem_fn == nullptr; });
+            tombstones = 0;
+        }
+
+        //stable grouping by invoker, handle references follow the moved objects
+        void sort_by_invoker() requires (not ordered)
+        {
+            std::stable_sort(objects.begin(), objects.end(), [](const delegate_object& a, const delegate_object& b)
+            {
+                return std::less<>()(a.mem_fn, b.mem_fn);
+            });
+        }
 
-        auto begin() { return objects.begin(); }
+    public:
+        using iterator = std::conditional_t<ordered, details::tombstone_skip_iterator<delegate_object>, typename std::vector<delegate_object>::iterator>;
 
-        auto end() { return objects.end(); }
-    };
+        iterator begin()
+        {
+            if constexpr (ordered) return iterator(objects.data(), objects.data() + objects.size());
+            else return objects.begin();
+        }
 
+        iterator end()
+        {
+            if constexpr (ordered) return iterator(objects.data() + objects.size(), objects.data() + objects.size());
+            else return objects.end();
+        }
+    };
 
     template<typename Func, typename DelegateContainer = default_delegate_container<>>
     class multicast_delegate;
 
-    template<typename DelegateContainer, typename Ret, typename... Args> requires (not std::is_rvalue_reference_v<Args> && ...)
-    class multicast_delegate<Ret(Args...), DelegateContainer>
+    //listeners are called in bind order, unbinding leaves a tombstone compacted in bulk
+    template<typename Func>
+    using multicast_ordered_delegate = multicast_delegate<Func, default_delegate_container<ordered_removal<>>>;
+
+    template<typename SlotTable>
+    class slot_map_delegate_handle;
+
+    //handles name a listener by slot index and generation instead of pointing at it
+    //listeners move on growth, swap back and compaction without any handle being touched, unbind and validity checks stay O(1)
+    template<typename RemovalPolicy = swap_back_removal>
+    class slot_map_delegate_container
+    {
+        struct slot_table;
+    public:
+        using delegate_handle_t = slot_map_delegate_handle<slot_table>;
+        using delegate_handle_t_ref = delegate_handle_t&;
+        //the listener names its slot, the only back reference kept up to date when it moves
+        using inverse_handle_t = uint32_t;
+        using inverse_handle_t_ref = uint32_t&;
+        static constexpr bool enable_delegate_handle = true;
+        static constexpr bool ordered = details::is_ordered_removal<RemovalPolicy>;
+
+    private:
+        friend delegate_handle_t;
+
+        struct delegate_object
+        {
+            void* ptr;
+            void* mem_fn;//null for a tombstone
+            uint32_t slot;
+        };
+
+        struct slot
+        {
+            //index in objects while the slot is in use, the next free slot otherwise
+            uint32_t index;
+            //bumped when the listener is removed, older handles no longer match
+            uint32_t generation;
+        };
+
+        static constexpr uint32_t no_slot = ~uint32_t(0);
+
+        //on the heap so a moved container keeps its handles valid
+        //outlives the container until the last handle is gone
+        struct slot_table
+        {
+            std::vector<delegate_object> objects;
+            std::vector<slot> slots;
+            uint32_t free_slot = no_slot;
+            size_t tombstones = 0;
+            size_t handles = 0;
+            bool orphaned = false;
+
+            bool contains(uint32_t s, uint32_t generation) const
+            {
+                assert(s < slots.size());
+                return slots[s].generation == generation;
+            }
+
+            uint32_t acquire(size_t index)
+            {
+                if (free_slot == no_slot)
+                {
+                    slots.push_back(slot{uint32_t(index), 0});
+                    return uint32_t(slots.size() - 1);
+                }
+                uint32_t s = std::exchange(free_slot, slots[free_slot].index);
+                slots[s].index = uint32_t(index);
+                return s;
+            }
+
+            void retire(uint32_t s)
+            {
+                ++slots[s].generation;
+                slots[s].index = std::exchange(free_slot, s);
+            }
+
+            void erase(uint32_t s, uint32_t generation)
+            {
+                if (not contains(s, generation)) return;
+                size_t index = slots[s].index;
+                retire(s);
+                if constexpr (ordered)
+                {
+                    objects[index] = delegate_object{nullptr, nullptr, 0};
+                    if (++tombstones * RemovalPolicy::compaction_ratio >= objects.size()) compact();
+                } else
+                {
+                    objects[index] = objects.back();
+                    objects.pop_back();
+                    if (index < objects.size()) slots[objects[index].slot].index = uint32_t(index);
+                }
+            }
+
+            void reindex()
+            {
+                for (size_t i = 0; i < objects.size(); ++i)
+                    if (objects[i].mem_fn) slots[objects[i].slot].index = uint32_t(i);
+            }
+
+            void compact()
+            {
+                std::erase_if(objects, [](const delegate_object& o) { return o.mem_fn == nullptr; });
+                tombstones = 0;
+                reindex();
+            }
+
+            void clear()
+            {
+                for (auto& o: objects)
+                    if (o.mem_fn) retire(o.slot);
+                objects.clear();
+                tombstones = 0;
+            }
+
+            void release_handle()
+            {
+                if (--handles == 0 and orphaned) delete this;
+            }
+        };
+
+        slot_table* table = nullptr;
+
+        slot_table& get_table()
+        {
+            if (!table) table = new slot_table();
+            return *table;
+        }
+
+    public:
+        slot_map_delegate_container() = default;
+
+        slot_map_delegate_container(const slot_map_delegate_container&) = delete;
+
+        slot_map_delegate_container(slot_map_delegate_container&& other) noexcept: table(std::exchange(other.table, nullptr)) {}
+
+        ~slot_map_delegate_container()
+        {
+            if (!table) return;
+            table->clear();
+            table->orphaned = true;
+            if (table->handles == 0) delete table;
+        }
+
+        auto size() { return table ? table->objects.size() - table->tombstones : 0; }
+
+        bool empty() { return size() == 0; }
+
+        //every handle bound so far becomes invalid
+        void clear() { if (table) table->clear(); }
+
+        delegate_handle_t bind(void* obj, void* invoker)
+        {
+            slot_table& t = get_table();
+            uint32_t s = t.acquire(t.objects.size());
+            t.objects.push_back(delegate_object{obj, invoker, s});
+            return delegate_handle_t(&t, s, t.slots[s].generation);
+        }
+
+        void unbind(delegate_handle_t_ref handle)
+        {
+            assert(!handle.table or handle.table == table);
+            handle.unbind();
+        }
+
+        //drops the tombstones in one pass, only the slots of the moved objects are rewritten
+        void compact() { if (table) table->compact(); }
+
+        //stable grouping by invoker, only the slots of the moved objects are rewritten
+        void sort_by_invoker() requires (not ordered)
+        {
+            if (!table) return;
+            std::stable_sort(table->objects.begin(), table->objects.end(), [](const delegate_object& a, const delegate_object& b)
+            {
+                return std::less<>()(a.mem_fn, b.mem_fn);
+            });
+            table->reindex();
+        }
+
+        using iterator = std::conditional_t<ordered, details::tombstone_skip_iterator<delegate_object>, delegate_object*>;
+
+        iterator begin()
+        {
+            delegate_object* first = table ? table->objects.data() : nullptr;
+            if constexpr (ordered) return iterator(first, first + size_t(table ? table->objects.size() : 0));
+            else return first;
+        }
+
+        iterator end()
+        {
+            delegate_object* last = table ? table->objects.data() + table->objects.size() : nullptr;
+            if constexpr (ordered) return iterator(last, last);
+            else return last;
+        }
+    };
+
+    //move only, unbinds its listener when destroyed
+    template<typename SlotTable>
+    class slot_map_delegate_handle
+    {
+        template<typename RemovalPolicy>
+        friend class slot_map_delegate_container;
+
+        SlotTable* table;
+        uint32_t slot;
+        uint32_t generation;
+
+        slot_map_delegate_handle(SlotTable* table, uint32_t slot, uint32_t generation)
+                : table(table), slot(slot), generation(generation) { ++table->handles; }
+
+    public:
+        slot_map_delegate_handle() : table(), slot(), generation() {}
+
+        slot_map_delegate_handle(const slot_map_delegate_handle&) = delete;
+
+        slot_map_delegate_handle(slot_map_delegate_handle&& other) noexcept
+                : table(std::exchange(other.table, nullptr)), slot(other.slot), generation(other.generation) {}
+
+        slot_map_delegate_handle& operator=(slot_map_delegate_handle&& other) noexcept
+        {
+            if (this == &other) return *this;
+            unbind();
+            table = std::exchange(other.table, nullptr);
+            slot = other.slot;
+            generation = other.generation;
+            return *this;
+        }
+
+        ~slot_map_delegate_handle() { unbind(); }
+
+        //false once the listener is unbound, the container is cleared or destroyed
+        [[nodiscard]] bool valid() const { return table and table->contains(slot, generation); }
+
+        void unbind()
+        {
+            if (!table) return;
+            table->erase(slot, generation);
+            release();
+        }
+
+        //keeps the listener bound for the lifetime of the container
+        void release()
+        {
+            if (!table) return;
+            std::exchange(table, nullptr)->release_handle();
+        }
+    };
+
+    //unbind by slot map handles, listener storage grows and compacts without patching any handle
+    template<typename Func>
+    using multicast_slot_map_delegate = multicast_delegate<Func, slot_map_delegate_container<>>;
+
+    //listener objects, invokers and inverse handles in separate parallel arrays
+    //an invoke streams only the object and invoker pointers, unbind keeps the three arrays in step
+    template<typename RemovalPolicy = swap_back_removal>
+    class soa_delegate_container
+    {
+    public:
+        using delegate_handle_t = unique_delegate_handle_container<soa_delegate_container>;
+        using delegate_handle_t_ref = typename delegate_handle_traits<delegate_handle_t>::delegate_handle_reference;
+        using inverse_handle_t = typename delegate_handle_traits<delegate_handle_t>::inverse_handle_type;
+        using inverse_handle_t_ref = typename delegate_handle_traits<delegate_handle_t>::inverse_handle_reference;
+        static constexpr bool enable_delegate_handle = delegate_handle_traits<delegate_handle_t>::enable_delegate_handle;
+        static constexpr bool ordered = details::is_ordered_removal<RemovalPolicy>;
+
+    private:
+        struct empty_t {};
+
+        std::vector<void*> ptrs;
+        std::vector<void*> mem_fns;//null for a tombstone
+        std::vector<inverse_handle_t> inv_handles;
+        size_t tombstones = 0;
+
+    public:
+        soa_delegate_container() = default;
+        soa_delegate_container(const soa_delegate_container&) = delete;
+        soa_delegate_container(soa_delegate_container&& other) noexcept
+                : ptrs(std::move(other.ptrs)), mem_fns(std::move(other.mem_fns)), inv_handles(std::move(other.inv_handles)),
+                  tombstones(std::exchange(other.tombstones, 0))
+        {
+            for (auto& ref: inv_handles)
+                ref.notify_container_moved(this);
+        }
+
+        auto size() { return ptrs.size() - tombstones; }
+
+        bool empty() { return size() == 0; }
+
+        void clear()
+        {
+            ptrs.clear();
+            mem_fns.clear();
+            inv_handles.clear();
+            tombstones = 0;
+        }
+
+        delegate_handle_t bind(void* obj, void* invoker)
+        {
+            ptrs.push_back(obj);
+            mem_fns.push_back(invoker);
+            return delegate_handle_t(this, &inv_handles.emplace_back());
+        }
+
+    private:
+        void remove_at(size_t index)
+        {
+            if constexpr (ordered)
+            {
+                ptrs[index] = nullptr;
+                mem_fns[index] = nullptr;
+                inv_handles[index] = inverse_handle_t{};
+                if (++tombstones * RemovalPolicy::compaction_ratio >= ptrs.size()) compact();
+            } else
+            {
+                ptrs[index] = ptrs.back();
+                mem_fns[index] = mem_fns.back();
+                inv_handles[index] = std::move(inv_handles.back());
+                ptrs.pop_back();
+                mem_fns.pop_back();
+                inv_handles.pop_back();
+            }
+        }
+
+    public:
+        void unbind(delegate_handle_t_ref handle)
+        {
+            inverse_handle_t* inv_handle = inverse_handle_t::get(&handle);
+            assert(inv_handle);
+            remove_at(inv_handle - inv_handles.data());
+        }
+
+        //drops the tombstones in one pass, handle references follow the moved objects
+        void compact()
+        {
+            size_t write = 0;
+            for (size_t read = 0; read < ptrs.size(); ++read)
+            {
+                if (mem_fns[read] == nullptr) continue;
+                if (write != read)
+                {
+                    ptrs[write] = ptrs[read];
+                    mem_fns[write] = mem_fns[read];
+                    inv_handles[write] = std::move(inv_handles[read]);
+                }
+                ++write;
+            }
+            ptrs.resize(write);
+            mem_fns.resize(write);
+            inv_handles.erase(inv_handles.begin() + write, inv_handles.end());
+            tombstones = 0;
+        }
+
+        //stable grouping by invoker, handle references follow the moved objects
+        void sort_by_invoker() requires (not ordered)
+        {
+            std::vector<size_t> order(ptrs.size());
+            for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+            std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b)
+            {
+                return std::less<>()(mem_fns[a], mem_fns[b]);
+            });
+            std::vector<void*> sorted_ptrs, sorted_mem_fns;
+            std::vector<inverse_handle_t> sorted_handles;
+            sorted_ptrs.reserve(order.size());
+            sorted_mem_fns.reserve(order.size());
+            sorted_handles.reserve(order.size());
+            for (size_t i: order)
+            {
+                sorted_ptrs.push_back(ptrs[i]);
+                sorted_mem_fns.push_back(mem_fns[i]);
+                sorted_handles.push_back(std::move(inv_handles[i]));
+            }
+            ptrs.swap(sorted_ptrs);
+            mem_fns.swap(sorted_mem_fns);
+            inv_handles.swap(sorted_handles);
+        }
+
+        //a listener read from both arrays, the inverse handle is never loaded
+        struct listener
+        {
+            void* ptr;
+            void* mem_fn;
+            [[DELEGATE_no_unique_address]] empty_t inv_handle;
+        };
+
+        class iterator
+        {
+            void* const* ptr;
+            void* const* mem_fn;
+            void* const* last;
+
+            void skip() { if constexpr (ordered) while (mem_fn != last and *mem_fn == nullptr) ++ptr, ++mem_fn; }
+
+        public:
+            using iterator_category = std::conditional_t<ordered, std::forward_iterator_tag, std::random_access_iterator_tag>;
+            using difference_type = std::ptrdiff_t;
+            using value_type = listener;
+            using reference = listener;
+
+            iterator() : ptr(), mem_fn(), last() {}
+
+            iterator(void* const* ptr, void* const* mem_fn, void* const* last) : ptr(ptr), mem_fn(mem_fn), last(last) { skip(); }
+
+            listener operator*() const { return {*ptr, *mem_fn, {}}; }
+
+            listener operator[](difference_type n) const requires (not ordered) { return {ptr[n], mem_fn[n], {}}; }
+
+            iterator& operator++()
+            {
+                ++ptr;
+                ++mem_fn;
+                skip();
+                return *this;
+            }
+
+            iterator operator++(int)
+            {
+                auto copy = *this;
+                operator++();
+                return copy;
+            }
+
+            iterator& operator--() requires (not ordered)
+            {
+                --ptr;
+                --mem_fn;
+                return *this;
+            }
+
+            iterator operator--(int) requires (not ordered)
+            {
+                auto copy = *this;
+                operator--();
+                return copy;
+            }
+
+            iterator& operator+=(difference_type n) requires (not ordered)
+            {
+                ptr += n;
+                mem_fn += n;
+                return *this;
+            }
+
+            iterator& operator-=(difference_type n) requires (not ordered) { return *this += -n; }
+
+            friend iterator operator+(iterator it, difference_type n) requires (not ordered) { return it += n; }
+
+            friend iterator operator+(difference_type n, iterator it) requires (not ordered) { return it += n; }
+
+            friend iterator operator-(iterator it, difference_type n) requires (not ordered) { return it -= n; }
+
+            friend difference_type operator-(const iterator& a, const iterator& b) requires (not ordered) { return a.mem_fn - b.mem_fn; }
+
+            bool operator==(const iterator& other) const { return mem_fn == other.mem_fn; }
+
+            auto operator<=>(const iterator& other) const { return mem_fn <=> other.mem_fn; }
+        };
+
+        iterator begin() { return iterator(ptrs.data(), mem_fns.data(), mem_fns.data() + mem_fns.size()); }
+
+        iterator end()
+        {
+            void* const* last = mem_fns.data() + mem_fns.size();
+            return iterator(ptrs.data() + ptrs.size(), last, last);
+        }
+    };
+
+    //listeners in parallel object and invoker arrays, the inverse handles are kept apart from the invoke loop
+    template<typename Func>
+    using multicast_soa_delegate = multicast_delegate<Func, soa_delegate_container<>>;
+
+    //listeners bucketed by invoker, every bucket is dispatched by one call to its batch invoker
+    //the batch invoker loops over the objects of the bucket and calls the target directly, listener order is not kept
+    class grouped_delegate_container
+    {
+    public:
+        using delegate_handle_t = unique_delegate_handle_container<grouped_delegate_container>;
+        using delegate_handle_t_ref = typename delegate_handle_traits<delegate_handle_t>::delegate_handle_reference;
+        using inverse_handle_t = typename delegate_handle_traits<delegate_handle_t>::inverse_handle_type;
+        using inverse_handle_t_ref = typename delegate_handle_traits<delegate_handle_t>::inverse_handle_reference;
+        static constexpr bool enable_delegate_handle = delegate_handle_traits<delegate_handle_t>::enable_delegate_handle;
+
+    private:
+        //the batch invokers are only walked by multicast_delegate::invoke
+        template<typename, typename>
+        friend class multicast_delegate;
+
+        //the handle reference carries the id of its bucket, unbind finds the bucket without a scan
+        struct handle_entry : inverse_handle_t
+        {
+            size_t group_id = 0;
+        };
+
+        struct group
+        {
+            void* mem_fn;
+            void* batch_invoker;
+            size_t id;
+            std::vector<void*> objects;
+            //parallel to objects, their buffer does not move with the group
+            std::vector<handle_entry> inv_handles;
+        };
+
+        struct empty_t {};
+
+        std::vector<group> groups_;
+        //bucket id to its place in groups_, patched when the last bucket fills a hole
+        std::vector<size_t> group_index;
+        std::vector<size_t> free_ids;
+        size_t count = 0;
+
+        std::span<const group> groups() const { return groups_; }
+
+    public:
+        grouped_delegate_container() = default;
+        grouped_delegate_container(const grouped_delegate_container&) = delete;
+        grouped_delegate_container(grouped_delegate_container&& other) noexcept
+                : groups_(std::move(other.groups_)), group_index(std::move(other.group_index)),
+                  free_ids(std::move(other.free_ids)), count(std::exchange(other.count, 0))
+        {
+            for (auto& g: groups_)
+                for (auto& ref: g.inv_handles)
+                    ref.notify_container_moved(this);
+        }
+
+        auto size() { return count; }
+
+        bool empty() { return count == 0; }
+
+        void clear()
+        {
+            groups_.clear();
+            group_index.clear();
+            free_ids.clear();
+            count = 0;
+        }
+
+        //the bucket is found by a scan over the distinct invokers
+        delegate_handle_t bind(void* obj, void* invoker, void* batch_invoker)
+        {
+            auto it = std::find_if(groups_.begin(), groups_.end(), [&](const group& g) { return g.mem_fn == invoker; });
+            group& g = it != groups_.end() ? *it : add_group(invoker, batch_invoker);
+            g.objects.push_back(obj);
+            ++count;
+            handle_entry& entry = g.inv_handles.emplace_back();
+            entry.group_id = g.id;
+            return delegate_handle_t(this, &entry);
+        }
+
+        void unbind(delegate_handle_t_ref handle)
+        {
+            auto* entry = static_cast<handle_entry*>(inverse_handle_t::get(&handle));
+            assert(entry);
+            size_t place = group_index[entry->group_id];
+            group& g = groups_[place];
+            size_t index = entry - g.inv_handles.data();
+            g.objects[index] = g.objects.back();
+            g.inv_handles[index] = std::move(g.inv_handles.back());
+            g.objects.pop_back();
+            g.inv_handles.pop_back();
+            --count;
+            if (g.objects.empty())
+            {
+                free_ids.push_back(g.id);
+                //the buffers of the moved group stay where they are
+                if (&g != &groups_.back())
+                {
+                    g = std::move(groups_.back());
+                    group_index[g.id] = place;
+                }
+                groups_.pop_back();
+            }
+        }
+
+    private:
+        group& add_group(void* invoker, void* batch_invoker)
+        {
+            size_t id = group_index.size();
+            if (free_ids.empty()) group_index.push_back(0);
+            else
+            {
+                id = free_ids.back();
+                free_ids.pop_back();
+            }
+            group_index[id] = groups_.size();
+            return groups_.emplace_back(group{invoker, batch_invoker, id, {}, {}});
+        }
+
+    public:
+
+        //a listener read from its bucket, for the calls that are not batched
+        struct listener
+        {
+            void* ptr;
+            void* mem_fn;
+            [[DELEGATE_no_unique_address]] empty_t inv_handle;
+        };
+
+        class iterator
+        {
+            const group* g;
+            const group* last;
+            size_t index;
+
+            void skip() { while (g != last and index == g->objects.size()) ++g, index = 0; }
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using difference_type = std::ptrdiff_t;
+            using value_type = listener;
+            using reference = listener;
+
+            iterator() : g(), last(), index() {}
+
+            iterator(const group* g, const group* last) : g(g), last(last), index() { skip(); }
+
+            listener operator*() const { return {g->objects[index], g->mem_fn, {}}; }
+
+            iterator& operator++()
+            {
+                ++index;
+                skip();
+                return *this;
+            }
+
+            iterator operator++(int)
+            {
+                auto copy = *this;
+                operator++();
+                return copy;
+            }
+
+            bool operator==(const iterator& other) const { return g == other.g and index == other.index; }
+        };
+
+        iterator begin() { return iterator(groups_.data(), groups_.data() + groups_.size()); }
+
+        iterator end() { return iterator(groups_.data() + groups_.size(), groups_.data() + groups_.size()); }
+    };
+
+    //listeners of the same target are called through one batch invoker call per invoke
+    template<typename Func>
+    using multicast_grouped_delegate = multicast_delegate<Func, grouped_delegate_container>;
+
+    template<typename DelegateContainer, typename Ret, typename... Args, bool NoExcept> requires (not std::is_rvalue_reference_v<Args> && ...)
+    class multicast_delegate<Ret(Args...) noexcept(NoExcept), DelegateContainer>
     {
         template<typename T, auto MemFunc>
-        static Ret Invoker(void* obj, Args... args)
+        static Ret Invoker(void* obj, Args... args) noexcept(NoExcept)
         {
             return (reinterpret_cast<T*>(obj)->*MemFunc)(std::forward<Args>(args)...);
         }
 
+        //the call is queued in the mailbox of the listener and made later by the draining thread
+        template<typename T, auto MemFunc>
+        static Ret PostInvoker(void* obj, Args... args) noexcept(NoExcept)
+        {
+            static_cast<mailbox_affinity&>(*reinterpret_cast<T*>(obj))
+                    .template post<T, MemFunc, Args...>(obj, std::forward<Args>(args)...);
+        }
+
         template<typename T, auto Lambda>
-        static Ret LambdaInvoker(void* obj, Args... args)
+        static Ret LambdaInvoker(void* obj, Args... args) noexcept(NoExcept)
         {
             return Lambda(*(T*) obj, std::forward<Args>(args)...);
         }
 
         template<auto Callable>
-        static Ret StaticInvoker(void*, Args... args)
+        static Ret StaticInvoker(void*, Args... args) noexcept(NoExcept)
         {
             return Callable(std::forward<Args>(args)...);
         }
 
         template<auto Lambda>
-        static Ret StaticLambdaInvoker(void*, Args... args)
+        static Ret StaticLambdaInvoker(void*, Args... args) noexcept(NoExcept)
         {
             return Lambda(std::forward<Args>(args)...);
         }
 
-        using invoker_t = Ret (*)(void*, Args...);
+        //calls one of the invokers above for every object of a bucket, the call is direct and can be inlined
+        template<auto Invoke>
+        static void BatchInvoker(void* const* objs, size_t n, Args... args) noexcept(NoExcept)
+        {
+            for (size_t i = 0; i < n; ++i)
+                Invoke(objs[i], args...);
+        }
+
+        using invoker_t = Ret (*)(void*, Args...) noexcept(NoExcept);
+        using batch_invoker_t = void (*)(void* const*, size_t, Args...) noexcept(NoExcept);
 
         template<class T>
         using mem_func_t = Ret(T::*)(Args...);
@@ -374,10 +1146,14 @@ namespace auto_delegate
 
         void clear() { objects.clear(); }
 
+        //groups listeners of the same invoker so consecutive calls hit the same target
+        //unbinding moves the last listener into the hole, call it again once the listeners are settled, not from inside an invoke
+        void sort_by_invoker() requires requires(object_container_t& c) { c.sort_by_invoker(); } { objects.sort_by_invoker(); }
+
     public:
 
-        using function_type = Ret(Args...);
-        using function_pointer = Ret(*)(Args...);
+        using function_type = Ret(Args...) noexcept(NoExcept);
+        using function_pointer = Ret(*)(Args...) noexcept(NoExcept);
 
         using delegate_handle_t = typename object_container_t::delegate_handle_t;
         using delegate_handle_t_ref = typename object_container_t::delegate_handle_t_ref;
@@ -385,26 +1161,62 @@ namespace auto_delegate
         using inverse_handle_t_ref = typename object_container_t::inverse_handle_t_ref;
         static const bool enable_delegate_handle = object_container_t::enable_delegate_handle;
 
+    private:
+        //a grouping container also takes the batch invoker of the bucket
+        template<auto Invoke>
+        delegate_handle_t bind_invoker(const auto& obj)
+        {
+            if constexpr (requires { objects.bind(obj, (void*) Invoke, (void*) BatchInvoker<Invoke>); })
+                return objects.bind(obj, (void*) Invoke, (void*) BatchInvoker<Invoke>);
+            else
+                return objects.bind(obj, (void*) Invoke);
+        }
+
+    public:
         //bind methods
         template<auto MemFunc, typename T_ptr> requires requires { typename std::pointer_traits<T_ptr>; }
+                                                        and details::nothrow_invocable_if<NoExcept, decltype(MemFunc), value_of<T_ptr>&, Args...>
         delegate_handle_t bind(const T_ptr& obj)
         {
-            return objects.bind(obj, (void*) Invoker<value_of<T_ptr>, MemFunc>);
+            return bind_invoker<Invoker<value_of<T_ptr>, MemFunc>>(obj);
         }
 
         //bind methods with signature inference
         template<typename T, mem_func_t<T> MemFunc, typename T_ptr> requires requires { typename std::pointer_traits<T_ptr>; }
+                                                                           and details::nothrow_invocable_if<NoExcept, decltype(MemFunc), value_of<T_ptr>&, Args...>
         delegate_handle_t bind(const T_ptr& obj)
         {
-            return objects.bind(obj, (void*) Invoker<value_of<T_ptr>, MemFunc>);
+            return bind_invoker<Invoker<value_of<T_ptr>, MemFunc>>(obj);
+        }
+
+        //bind methods of a listener owned by another thread, invoke posts the call to the mailbox of the listener
+        //the arguments are copied, a listener destroyed before the mailbox is drained is skipped
+        //each post allocates the call, with a noexcept signature the copies must not throw and running out of memory terminates
+        template<auto MemFunc, typename T_ptr> requires requires { typename std::pointer_traits<T_ptr>; }
+                                                        and std::same_as<Ret, void> and std::derived_from<value_of<T_ptr>, mailbox_affinity>
+                                                        and details::nothrow_invocable_if<NoExcept, decltype(MemFunc), value_of<T_ptr>&, Args...>
+                                                        and details::nothrow_postable_if<NoExcept, Args...>
+        delegate_handle_t bind_posted(const T_ptr& obj)
+        {
+            return bind_invoker<PostInvoker<value_of<T_ptr>, MemFunc>>(obj);
+        }
+
+        template<typename T, mem_func_t<T> MemFunc, typename T_ptr> requires requires { typename std::pointer_traits<T_ptr>; }
+                                                                           and std::same_as<Ret, void> and std::derived_from<value_of<T_ptr>, mailbox_affinity>
+                                                                           and details::nothrow_invocable_if<NoExcept, decltype(MemFunc), value_of<T_ptr>&, Args...>
+                                                                           and details::nothrow_postable_if<NoExcept, Args...>
+        delegate_handle_t bind_posted(const T_ptr& obj)
+        {
+            return bind_invoker<PostInvoker<value_of<T_ptr>, MemFunc>>(obj);
         }
 
         //bind object with lambda
         template<typename T_ptr, typename Callable>
         requires std::is_empty_v<Callable> && requires { LambdaInvoker<value_of<T_ptr>, std::decay_t<Callable>{}>; }
+                 && details::nothrow_invocable_if<NoExcept, std::decay_t<Callable>, value_of<T_ptr>&, Args...>
         delegate_handle_t bind(const T_ptr& obj, Callable&& func)
         {
-            return objects.bind(obj, (void*) LambdaInvoker<value_of<T_ptr>, std::decay_t<Callable>{}>);
+            return bind_invoker<LambdaInvoker<value_of<T_ptr>, std::decay_t<Callable>{}>>(obj);
         }
 
         //bind callable object
@@ -412,9 +1224,9 @@ namespace auto_delegate
         delegate_handle_t bind(const T_ptr& callable)
         requires
         std::same_as<std::invoke_result_t<std::decay_t<decltype(*callable)>, Args...>, Ret>
+        and details::nothrow_invocable_if<NoExcept, std::decay_t<decltype(*callable)>&, Args...>
         {
-            return objects.bind(callable, (void*)
-                    Invoker<value_of<T_ptr>, &std::decay_t<decltype(*callable)>::operator()>);
+            return bind_invoker<Invoker<value_of<T_ptr>, &std::decay_t<decltype(*callable)>::operator()>>(callable);
         }
 
         //bind a stateless callable object
@@ -422,16 +1234,17 @@ namespace auto_delegate
         delegate_handle_t bind(Callable&& callable)
         requires enable_delegate_handle and
                  std::same_as<std::invoke_result_t<std::decay_t<Callable>, Args...>, Ret> and
-                 std::is_empty_v<std::decay_t<Callable>>
+                 std::is_empty_v<std::decay_t<Callable>> and
+                 details::nothrow_invocable_if<NoExcept, std::decay_t<Callable>, Args...>
         {
-            return objects.bind(nullptr, (void*) StaticLambdaInvoker<Callable{}>);
+            return bind_invoker<StaticLambdaInvoker<Callable{}>>(nullptr);
         }
 
         //bind static function
         template<function_pointer StaticFunc>
         delegate_handle_t bind() requires enable_delegate_handle
         {
-            return objects.bind(nullptr, (void*) StaticInvoker<StaticFunc>);
+            return bind_invoker<StaticInvoker<StaticFunc>>(nullptr);
         }
 
 
@@ -447,7 +1260,7 @@ namespace auto_delegate
         void unbind(delegate_handle_t_ref handle) requires enable_delegate_handle { objects.unbind(handle); }
 
     private:
-        static Ret invoke_single(const auto& ptr, void* invoker, Args... args)
+        static Ret invoke_single(const auto& ptr, void* invoker, Args... args) noexcept(NoExcept)
         {
             void* c;
             if constexpr (requires { static_cast<void*>(ptr); })
@@ -464,21 +1277,64 @@ namespace auto_delegate
             return reinterpret_cast<invoker_t>(invoker)(c, std::forward<Args>(args)...);
         }
 
+        //a weak pointer is not locked twice, only its invoker is prefetched
+        static void prefetch_single(const auto& ptr, void* invoker, prefetch_distance distance) noexcept
+        {
+            if constexpr (requires { static_cast<void*>(ptr); })
+                details::prefetch_read(static_cast<void*>(ptr));
+            else if constexpr (requires { ptr.get(); })
+                details::prefetch_read(reinterpret_cast<void*>(ptr.get()));
+            if (distance.invoker) details::prefetch_read(invoker);
+        }
+
     public:
         //no need to forward as the parameters types are already defined
-        void invoke(Args... args) requires std::same_as<Ret, void>
+        void invoke(Args... args) noexcept(NoExcept) requires std::same_as<Ret, void>
         {
-            for (auto&& [obj, mem_fn, _]: objects)
+            if constexpr (requires { objects.groups(); })
             {
-                invoke_single(obj, mem_fn, std::forward<Args>(args)...);
-            }
+                //one indirect call per bucket
+                for (auto& group: objects.groups())
+                    reinterpret_cast<batch_invoker_t>(group.batch_invoker)(group.objects.data(), group.objects.size(), args...);
+            } else
+                for (auto&& [obj, mem_fn, _]: objects)
+                {
+                    invoke_single(obj, mem_fn, std::forward<Args>(args)...);
+                }
         }
 
-        void operator()(Args... args) requires std::same_as<Ret, void>
+        void operator()(Args... args) noexcept(NoExcept) requires std::same_as<Ret, void>
         {
             invoke(std::forward<Args>(args)...);
         }
 
+        //the object of the listener distance.listeners ahead is prefetched before each call
+        //pays off when the bound objects are scattered over the heap and do not stay in cache between invokes
+        //the weak containers compact while iterating, a second iterator running ahead is not supported
+        void prefetch_invoke(prefetch_distance distance, Args... args) noexcept(NoExcept)
+        requires std::same_as<Ret, void>
+                 and std::same_as<typename object_container_t::iterator, decltype(std::declval<object_container_t&>().end())>
+        {
+            auto ahead = objects.begin();
+            const auto last = objects.end();
+            for (size_t i = 0; i < distance.listeners and ahead != last; ++i, ++ahead)
+            {
+                auto&& [obj, mem_fn, _] = *ahead;
+                prefetch_single(obj, mem_fn, distance);
+            }
+            for (auto it = objects.begin(); it != last; ++it)
+            {
+                if (ahead != last)
+                {
+                    auto&& [obj, mem_fn, _] = *ahead;
+                    prefetch_single(obj, mem_fn, distance);
+                    ++ahead;
+                }
+                auto&& [obj, mem_fn, _] = *it;
+                invoke_single(obj, mem_fn, args...);
+            }
+        }
+
         template<typename Callable>
         requires (!std::same_as<Ret, void>)
         void for_each_invoke(Args... args, Callable&& result_proc)
@@ -488,6 +1344,20 @@ namespace auto_delegate
                 result_proc(invoke_single(obj, mem_fn, std::forward<Args>(args)...));
             }
         }
+
+        //folds the results through a combiner from auto_delegate::combiners, stops early once it has its answer
+        template<typename Combiner>
+        requires (!std::same_as<Ret, void>) and result_combiner<std::decay_t<Combiner>, Ret>
+        auto combine(Combiner&& combiner, Args... args)
+        {
+            return details::combine<Ret>(combiner, [&](auto&& push)
+            {
+                for (auto&& [obj, mem_fn, _]: objects)
+                {
+                    if (!push(invoke_single(obj, mem_fn, args...))) break;
+                }
+            });
+        }
         template<typename Callable>
         void for_each(Callable&& func)
         {
@@ -499,6 +1369,71 @@ namespace auto_delegate
             }
         }
 
+        //listener major, every listener handles the whole batch before the next one is called
+        void invoke_batch(std::span<const std::tuple<Args...>> batch) noexcept(NoExcept) requires std::same_as<Ret, void>
+        {
+            for (auto&& [obj, mem_fn, _]: objects)
+            {
+                for (auto& args: batch)
+                    std::apply([&](auto& ... a) { invoke_single(obj, mem_fn, a...); }, args);
+            }
+        }
+
+        //listeners are split in chunks run concurrently by the executor, binding or unbinding meanwhile is not supported
+        template<bulk_executor Executor>
+        void parallel_invoke(Executor&& executor, parallel_grain grain, Args... args)
+        requires std::same_as<Ret, void> and std::random_access_iterator<typename object_container_t::iterator>
+        {
+            auto first = objects.begin();
+            details::parallel_for_chunks(executor, first, size_t(objects.end() - first), grain, [&](size_t, auto it, auto last)
+            {
+                for (; it != last; ++it)
+                {
+                    auto&& [obj, mem_fn, _] = *it;
+                    invoke_single(obj, mem_fn, args...);
+                }
+            });
+        }
+
+        template<bulk_executor Executor>
+        void parallel_invoke(Executor&& executor, Args... args)
+        requires std::same_as<Ret, void> and std::random_access_iterator<typename object_container_t::iterator>
+        {
+            parallel_invoke(executor, parallel_grain{}, args...);
+        }
+
+        //each chunk folds its results from identity, the partial results are then reduced in listener order
+        template<bulk_executor Executor, typename T, typename Reduce>
+        requires (!std::same_as<Ret, void>) and std::random_access_iterator<typename object_container_t::iterator>
+                 and std::is_invocable_r_v<T, Reduce&, T, Ret> and std::is_invocable_r_v<T, Reduce&, T, T>
+        T parallel_invoke(Executor&& executor, parallel_grain grain, T identity, Reduce&& reduce, Args... args)
+        {
+            auto first = objects.begin();
+            size_t count = objects.end() - first;
+            std::vector<T> partial(details::chunk_count<std::decay_t<decltype(*first)>>(count, grain), identity);
+            details::parallel_for_chunks(executor, first, count, grain, [&](size_t chunk_index, auto it, auto last)
+            {
+                T result = identity;
+                for (; it != last; ++it)
+                {
+                    auto&& [obj, mem_fn, _] = *it;
+                    result = reduce(std::move(result), invoke_single(obj, mem_fn, args...));
+                }
+                partial[chunk_index] = std::move(result);
+            });
+            for (auto& p: partial)
+                identity = reduce(std::move(identity), std::move(p));
+            return identity;
+        }
+
+        template<bulk_executor Executor, typename T, typename Reduce>
+        requires (!std::same_as<Ret, void>) and std::random_access_iterator<typename object_container_t::iterator>
+                 and std::is_invocable_r_v<T, Reduce&, T, Ret> and std::is_invocable_r_v<T, Reduce&, T, T>
+        T parallel_invoke(Executor&& executor, T identity, Reduce&& reduce, Args... args)
+        {
+            return parallel_invoke(executor, parallel_grain{}, std::move(identity), std::forward<Reduce>(reduce), args...);
+        }
+
     private:
         template<typename Invoker>
         class iterable
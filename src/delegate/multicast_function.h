@@ -5,9 +5,17 @@
 
 #include "function.h"
 #include "multicast_delegate.h"
+#include "parallel_invoke.h"
 #include <vector>
+#include <algorithm>
 #include <array>
 #include <optional>
+#include <utility>
+#include <mutex>
+#include <functional>
+#include <span>
+#include <tuple>
+#include <cstring>
 
 #ifdef no_unique_address
 #undef no_unique_address
@@ -19,15 +27,34 @@
 namespace auto_delegate
 {
 
-    template<typename Func>
+    //listeners are packed at their own size in one arena instead of one function each
+    //removal leaves a tombstone, compacted once tombstones make up 1 / CompactionRatio of the listeners
+    template<size_t CompactionRatio = 4>
+    struct packed_storage
+    {
+        static_assert(CompactionRatio > 0);
+        static constexpr size_t compaction_ratio = CompactionRatio;
+    };
+
+    namespace details
+    {
+        template<typename StoragePolicy>
+        constexpr bool is_packed_storage = false;
+
+        template<size_t CompactionRatio>
+        constexpr bool is_packed_storage<packed_storage<CompactionRatio>> = true;
+    }
+
+    //StoragePolicy is swap_back_removal, ordered_removal or packed_storage
+    template<typename Func, typename Function = function<Func>, typename StoragePolicy = swap_back_removal>
     class multicast_function;
 
-    template<typename Ret, typename... Args> requires (not std::is_rvalue_reference_v<Args> && ...)
+    template<typename Ret, typename... Args, bool NoExcept, typename Function, typename StoragePolicy> requires (not std::is_rvalue_reference_v<Args> && ...)
 
-    class multicast_function<Ret(Args...)>
+    class multicast_function<Ret(Args...) noexcept(NoExcept), Function, StoragePolicy>
     {
 
-        using invoker_t = Ret (*)(void*, Args...);
+        using invoker_t = Ret (*)(void*, Args...) noexcept(NoExcept);
 
         template<class T>
         using mem_func_t = Ret(T::*)(Args...);
@@ -35,99 +62,670 @@ namespace auto_delegate
         using wrapper_ret_t = std::conditional_t<std::is_void_v<Ret>, void, std::optional<Ret>>;
 
     public:
-        using function_t = function<Ret(Args...)>;
+        using function_t = Function;
+        using allocator_t = typename function_t::allocator_t;
 
-        struct object_container : public std::vector<function_t>
+        //iteration state shared by the listener containers
+        struct call_state
+        {
+            //nested invokes share the live range, only the outermost one compacts it
+            size_t nesting = 0;
+            //set when remove_on_call returns without calling anything, per thread for parallel invokes
+            inline static thread_local bool fake_return = false;
+
+            //removals requested while the live range is walked out of order, compacted when the walk is done
+            struct deferred_removal
+            {
+                //listeners run concurrently, binding and nested invokes are not supported
+                bool concurrent;
+                std::mutex mutex;
+                std::vector<size_t> removed;
+            };
+            deferred_removal* deferred = nullptr;
+
+            static Ret skip_call() noexcept
+            {
+                fake_return = true;
+                if constexpr (not std::is_void_v<Ret>)
+                {
+                    union no_return
+                    {
+                        Ret ret;
+                        std::array<uint8_t, sizeof(Ret)> dammy;
+                        no_return() { dammy.fill(0xFF); }
+                    };
+                    return no_return().ret;
+                } else return;
+            }
+        };
+
+        struct vector_object_container : public std::vector<function_t>, call_state
         {
             using super = std::vector<function_t>;
+            using call_state::nesting;
+            using call_state::fake_return;
+            using call_state::deferred;
+            using call_state::skip_call;
+            using typename call_state::deferred_removal;
+
             super::iterator iteraion_end;
-#ifndef NDEBUG
-            bool in_iteration = false;
-#endif
+            //callables bound during a call, appended when the outermost iteration ends
+            std::vector<function_t> pending;
+
+            static constexpr bool packed = false;
+            static constexpr bool ordered = details::is_ordered_removal<StoragePolicy>;
+            //a tombstone is called like any listener and makes a fake return, the result of a non void one is never read
+            static_assert(not ordered or std::is_void_v<Ret> or std::is_trivially_copyable_v<Ret>,
+                          "ordered removal requires a trivially copyable result");
+            //indices of the removed callables of an ordered container, still in the live range
+            std::vector<size_t> tombstones;
+
+            struct tombstone
+            {
+                Ret operator()(Args...) const noexcept { return skip_call(); }
+            };
+
+            vector_object_container() = default;
+
+            //the callables allocate from the allocator given at bind
+            explicit vector_object_container(const allocator_t&) {}
+
+            vector_object_container(vector_object_container&& other) noexcept:
+                    super(std::move(other)), pending(std::move(other.pending)),
+                    tombstones(std::move(other.tombstones)) {}
 
             void remove(const void* func)
             {
-                assert(!in_iteration);
+                assert(nesting == 0);
                 assert((intptr_t(func) - intptr_t(super::data())) % sizeof(function_t) == 0);
                 size_t index = (function_t*) func - super::data();
-                auto& back = super::back();
-                super::data()[index] = std::move(back);
-                super::pop_back();
+                if constexpr (ordered)
+                {
+                    bury(index);
+                    compact_if_needed();
+                } else
+                {
+                    auto& back = super::back();
+                    super::data()[index] = std::move(back);
+                    super::pop_back();
+                }
+            }
+
+            void bury(size_t index)
+            {
+                super::data()[index] = function_t(tombstone{});
+                tombstones.push_back(index);
             }
 
+            void compact_if_needed()
+            {
+                if (tombstones.empty() or tombstones.size() * StoragePolicy::compaction_ratio < super::size()) return;
+                //one pass from the first hole, handle references follow the moved callables
+                std::sort(tombstones.begin(), tombstones.end());
+                function_t* data = super::data();
+                size_t write = tombstones.front();
+                size_t next = 0;
+                for (size_t read = write; read < super::size(); ++read)
+                {
+                    if (next < tombstones.size() and tombstones[next] == read) ++next;
+                    else data[write++] = std::move(data[read]);
+                }
+                super::erase(super::begin() + write, super::end());
+                tombstones.clear();
+            }
+
+            void clear()
+            {
+                super::clear();
+                tombstones.clear();
+            }
+
+            size_t live_size() const { return super::size() - tombstones.size(); }
+
+            size_t memory_size() const { return super::size() * sizeof(function_t); }
+
             Ret remove_on_call(const void* func, Args... args)
             {
-                assert(in_iteration);
+                assert(nesting);
                 assert((intptr_t(func) - intptr_t(super::data())) % sizeof(function_t) == 0);
+                //an outer iteration may still be inside this callable, it is removed by a later outermost call
+                if (nesting > 1) return skip_call();
                 size_t index = (function_t*) func - super::data();
+                if (deferred)
+                {
+                    std::lock_guard lock(deferred->mutex);
+                    deferred->removed.push_back(index);
+                    return skip_call();
+                }
+                if constexpr (ordered)
+                {
+                    bury(index);
+                    return skip_call();
+                }
                 function_t& current = super::at(index);
                 --iteraion_end;
                 auto& end = *iteraion_end;
                 //if last element is remove in call would cause a fake return
-                if (&current == &end)
-                {
-                    if constexpr (not std::is_void_v<Ret>)
-                    {
-                        union no_return
-                        {
-                            Ret ret;
-                            std::array<uint8_t, sizeof(Ret)> dammy;
-                            no_return() { dammy.fill(0xFF); }
-                        };
-                        return no_return().ret;
-                    } else return;
-                }
+                if (&current == &end) return skip_call();
                 current = std::move(end);
                 return current(std::forward<Args>(args)...);
             }
 
             void release_removed()
             {
-#ifndef NDEBUG
-                assert(in_iteration);
-                in_iteration = false;
-#endif
+                assert(nesting);
+                fake_return = false;
+                if (--nesting) return;
                 super::erase(iteraion_end, super::end());
+                if constexpr (ordered) compact_if_needed();
+                for (auto& f: pending)
+                    super::emplace_back(std::move(f));
+                pending.clear();
+            }
+
+            //binding inside a call is queued, the live storage is never reallocated under an iteration
+            template<typename... T>
+            function_t& emplace_back(T&& ... args)
+            {
+                assert(not deferred or not deferred->concurrent);
+                if (nesting) return pending.emplace_back(std::forward<T>(args)...);
+                return super::emplace_back(std::forward<T>(args)...);
             }
 
-            using super::emplace_back;
             using super::begin;
 
             const super::iterator& end()
             {
-#ifndef NDEBUG
-                assert(!in_iteration);
-                in_iteration = true;
-#endif
-                iteraion_end = super::end();
+                assert(not deferred or not deferred->concurrent);
+                if (nesting++ == 0) iteraion_end = super::end();
                 return iteraion_end;
             }
+
+            //stable grouping by callable type, a type is always called through the same invoker
+            void sort_by_invoker() requires (not ordered)
+            {
+                assert(nesting == 0);
+                std::vector<std::pair<type_id_t, size_t>> keys;
+                keys.reserve(super::size());
+                for (size_t i = 0; i < super::size(); ++i)
+                    keys.emplace_back(super::data()[i].target_type_id(), i);
+                std::stable_sort(keys.begin(), keys.end(), [](auto& a, auto& b) { return std::less<>()(a.first, b.first); });
+                //moved one by one, handle references follow the moved callables
+                super sorted;
+                sorted.reserve(super::size());
+                for (auto& [_, index]: keys)
+                    sorted.emplace_back(std::move(super::data()[index]));
+                super::swap(sorted);
+            }
+
+            const super::iterator& begin_deferred(deferred_removal& state)
+            {
+                assert(nesting == 0);
+                end();
+                deferred = &state;
+                return iteraion_end;
+            }
+
+            //drops the listeners whose target is gone, between calls so no dispatch meets them
+            size_t remove_expired()
+            {
+                assert(nesting == 0);
+                size_t removed = 0;
+                function_t* data = super::data();
+                if constexpr (ordered)
+                {
+                    for (size_t i = 0; i < super::size(); ++i)
+                    {
+                        if (not data[i].expired()) continue;
+                        bury(i);
+                        ++removed;
+                    }
+                    if (removed) compact_if_needed();
+                } else
+                {
+                    //from the back, the element moved into a hole is already checked
+                    for (size_t i = super::size(); i-- > 0;)
+                    {
+                        if (not data[i].expired()) continue;
+                        data[i] = std::move(super::back());
+                        super::pop_back();
+                        ++removed;
+                    }
+                }
+                return removed;
+            }
+
+            void release_deferred()
+            {
+                //from the back, so the live element moved into a hole is never one still to be removed
+                auto& removed = deferred->removed;
+                std::sort(removed.begin(), removed.end(), std::greater<>());
+                removed.erase(std::unique(removed.begin(), removed.end()), removed.end());
+                for (size_t index: removed)
+                {
+                    if constexpr (ordered) bury(index);
+                    else
+                    {
+                        --iteraion_end;
+                        function_t& current = super::data()[index];
+                        if (&current != &*iteraion_end) current = std::move(*iteraion_end);
+                    }
+                }
+                deferred = nullptr;
+                release_removed();
+            }
         };
 
+        //listeners packed at their own size in one arena, each record a header followed by the callable
+        //removal leaves a tombstone in place, listeners are called in bind order
+        struct packed_object_container : call_state
+        {
+            static constexpr bool ordered = true;
+            static constexpr bool packed = true;
+            static_assert(std::is_void_v<Ret> or std::is_trivially_copyable_v<Ret>,
+                          "packed storage requires a trivially copyable result");
+
+            enum class record_op
+            {
+                relocate,
+                destroy,
+                expired
+            };
+
+            struct record
+            {
+                using record_invoker_t = Ret (*)(void*, Args...) noexcept(NoExcept);
+                using record_manager_t = bool (*)(record_op op, void* dst, void* src) noexcept;
+
+                record_invoker_t invoker;
+                //null when the callable is trivially copyable and not expirable
+                record_manager_t manager;
+                //header and callable, a multiple of the header alignment
+                size_t size;
+
+                void* callee() { return this + 1; }
+
+                Ret operator()(Args... args) noexcept(NoExcept) { return invoker(callee(), std::forward<Args>(args)...); }
+            };
+
+            template<typename Callable>
+            static Ret invoke_record(void* callee, Args... args) noexcept(NoExcept)
+            {
+                return (*static_cast<Callable*>(callee))(std::forward<Args>(args)...);
+            }
+
+            template<typename Callable>
+            static bool manage_record(record_op op, void* dst, void* src) noexcept
+            {
+                auto& callable = *static_cast<Callable*>(src);
+                switch (op)
+                {
+                    case record_op::relocate:
+                        if constexpr (is_trivially_relocatable_v<Callable>)
+                            std::memcpy(dst, src, sizeof(Callable));
+                        else
+                        {
+                            ::new(dst) Callable(std::move(callable));
+                            callable.~Callable();
+                        }
+                        break;
+                    case record_op::destroy:
+                        callable.~Callable();
+                        break;
+                    case record_op::expired:
+                        if constexpr (expirable<Callable>) return callable.expired();
+                        break;
+                }
+                return false;
+            }
+
+            static Ret invoke_tombstone(void*, Args...) noexcept { return call_state::skip_call(); }
+
+            using unit_t = std::max_align_t;
+            using arena_allocator_t = typename std::allocator_traits<allocator_t>::template rebind_alloc<unit_t>;
+
+            struct arena
+            {
+                std::byte* data = nullptr;
+                size_t used = 0;
+                size_t capacity = 0;
+            };
+
+            class iterator
+            {
+                std::byte* it = nullptr;
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using difference_type = std::ptrdiff_t;
+                using value_type = record;
+                using pointer = record*;
+                using reference = record&;
+
+                iterator() = default;
+
+                explicit iterator(std::byte* it) : it(it) {}
+
+                record& operator*() const { return *reinterpret_cast<record*>(it); }
+
+                iterator& operator++()
+                {
+                    it += reinterpret_cast<record*>(it)->size;
+                    return *this;
+                }
+
+                iterator operator++(int)
+                {
+                    auto copy = *this;
+                    operator++();
+                    return copy;
+                }
+
+                bool operator==(const iterator&) const = default;
+
+                auto operator<=>(const iterator&) const = default;
+            };
+
+            [[no_unique_address]] arena_allocator_t arena_allocator;
+            arena live;
+            //callables bound during a call, appended when the outermost iteration ends
+            arena pending;
+            size_t count = 0;
+            size_t tombstones = 0;
+            iterator iteraion_end;
+
+            packed_object_container() = default;
+
+            explicit packed_object_container(const allocator_t& alloc) : arena_allocator(alloc) {}
+
+            packed_object_container(packed_object_container&& other) noexcept:
+                    arena_allocator(other.arena_allocator),
+                    live(std::exchange(other.live, {})), pending(std::exchange(other.pending, {})),
+                    count(std::exchange(other.count, 0)), tombstones(std::exchange(other.tombstones, 0)) {}
+
+            ~packed_object_container()
+            {
+                clear();
+                deallocate(live);
+                deallocate(pending);
+            }
+
+            size_t live_size() const { return count - tombstones; }
+
+            //bytes of the records, tombstones included
+            size_t memory_size() const { return live.used; }
+
+            void clear()
+            {
+                assert(call_state::nesting == 0);
+                destroy_all(live);
+                destroy_all(pending);
+                count = tombstones = 0;
+            }
+
+            template<typename Callable>
+            static constexpr size_t record_size()
+            {
+                constexpr size_t align = alignof(record);
+                return (sizeof(record) + sizeof(Callable) + align - 1) / align * align;
+            }
+
+            //binding inside a call is queued, the live arena is never reallocated under an iteration
+            template<typename Callable>
+            std::decay_t<Callable>& emplace_back(std::allocator_arg_t, const allocator_t&, Callable&& callable)
+            {
+                using callable_t = std::decay_t<Callable>;
+                static_assert(alignof(callable_t) <= alignof(record), "over aligned callables can not be packed");
+                assert(not call_state::deferred or not call_state::deferred->concurrent);
+                arena& target = call_state::nesting ? pending : live;
+                constexpr size_t size = record_size<callable_t>();
+                if (target.used + size > target.capacity)
+                    reallocate(target, std::max({target.capacity * 2, target.used + size, size_t(1024)}));
+                auto* r = ::new(target.data + target.used) record{
+                        invoke_record<callable_t>,
+                        std::is_trivially_copyable_v<callable_t> and not expirable<callable_t>
+                        ? nullptr : manage_record<callable_t>,
+                        size};
+                auto* callee = ::new(r->callee()) callable_t(std::forward<Callable>(callable));
+                target.used += size;
+                ++count;
+                return *callee;
+            }
+
+            iterator begin() { return iterator(live.data); }
+
+            const iterator& end()
+            {
+                assert(not call_state::deferred or not call_state::deferred->concurrent);
+                if (call_state::nesting++ == 0) iteraion_end = iterator(live.data + live.used);
+                return iteraion_end;
+            }
+
+            void remove(const void* func)
+            {
+                assert(call_state::nesting == 0);
+                bury(record_of(func));
+                compact_if_needed();
+            }
+
+            Ret remove_on_call(const void* func, Args...)
+            {
+                assert(call_state::nesting);
+                //an outer iteration may still be inside this callable, it is removed by a later outermost call
+                if (call_state::nesting > 1) return call_state::skip_call();
+                record* r = record_of(func);
+                if (call_state::deferred)
+                {
+                    std::lock_guard lock(call_state::deferred->mutex);
+                    call_state::deferred->removed.push_back((std::byte*) r - live.data);
+                    return call_state::skip_call();
+                }
+                bury(r);
+                return call_state::skip_call();
+            }
+
+            void release_removed()
+            {
+                assert(call_state::nesting);
+                call_state::fake_return = false;
+                if (--call_state::nesting) return;
+                if (pending.used)
+                {
+                    if (live.used + pending.used > live.capacity)
+                        reallocate(live, std::max(live.capacity * 2, live.used + pending.used));
+                    relocate_all(pending, live);
+                }
+                compact_if_needed();
+            }
+
+            const iterator& begin_deferred(typename call_state::deferred_removal& state)
+            {
+                assert(call_state::nesting == 0);
+                end();
+                call_state::deferred = &state;
+                return iteraion_end;
+            }
+
+            void release_deferred()
+            {
+                //one listener may expire on several calls of a batch
+                auto& removed = call_state::deferred->removed;
+                std::sort(removed.begin(), removed.end());
+                removed.erase(std::unique(removed.begin(), removed.end()), removed.end());
+                for (size_t offset: removed)
+                    bury(reinterpret_cast<record*>(live.data + offset));
+                call_state::deferred = nullptr;
+                release_removed();
+            }
+
+            //drops the listeners whose target is gone, between calls so no dispatch meets them
+            size_t remove_expired()
+            {
+                assert(call_state::nesting == 0);
+                size_t removed = 0;
+                for (auto it = begin(); it != iterator(live.data + live.used); ++it)
+                {
+                    record& r = *it;
+                    if (r.manager and r.manager(record_op::expired, nullptr, r.callee()))
+                    {
+                        bury(&r);
+                        ++removed;
+                    }
+                }
+                if (removed) compact_if_needed();
+                return removed;
+            }
+
+        private:
+            static record* record_of(const void* func)
+            {
+                return static_cast<record*>(const_cast<void*>(func)) - 1;
+            }
+
+            void bury(record* r)
+            {
+                if (r->manager) r->manager(record_op::destroy, nullptr, r->callee());
+                r->invoker = invoke_tombstone;
+                r->manager = nullptr;
+                ++tombstones;
+            }
+
+            void compact_if_needed()
+            {
+                if (tombstones == 0 or tombstones * StoragePolicy::compaction_ratio < count) return;
+                //only tombstones left, they own nothing and the arena is kept for the next binds
+                if (tombstones == count)
+                {
+                    live.used = 0;
+                    count = tombstones = 0;
+                    return;
+                }
+                reallocate(live, live.capacity);
+            }
+
+            static void destroy_all(arena& a)
+            {
+                for (size_t offset = 0; offset < a.used;)
+                {
+                    auto* r = reinterpret_cast<record*>(a.data + offset);
+                    if (r->manager) r->manager(record_op::destroy, nullptr, r->callee());
+                    offset += r->size;
+                }
+                a.used = 0;
+            }
+
+            //appends the live records of from to the end of to, tombstones are dropped
+            void relocate_all(arena& from, arena& to)
+            {
+                for (size_t offset = 0; offset < from.used;)
+                {
+                    auto* r = reinterpret_cast<record*>(from.data + offset);
+                    offset += r->size;
+                    if (r->invoker == invoke_tombstone)
+                    {
+                        --count;
+                        --tombstones;
+                        continue;
+                    }
+                    auto* moved = ::new(to.data + to.used) record(*r);
+                    //handle references follow the moved callables
+                    if (r->manager) r->manager(record_op::relocate, moved->callee(), r->callee());
+                    else std::memcpy(moved->callee(), r->callee(), r->size - sizeof(record));
+                    to.used += r->size;
+                }
+                from.used = 0;
+            }
+
+            void reallocate(arena& a, size_t capacity)
+            {
+                arena moved;
+                moved.capacity = (capacity + sizeof(unit_t) - 1) / sizeof(unit_t) * sizeof(unit_t);
+                moved.data = reinterpret_cast<std::byte*>(arena_allocator.allocate(moved.capacity / sizeof(unit_t)));
+                relocate_all(a, moved);
+                deallocate(a);
+                a = moved;
+            }
+
+            void deallocate(arena& a)
+            {
+                if (a.data) arena_allocator.deallocate(reinterpret_cast<unit_t*>(a.data), a.capacity / sizeof(unit_t));
+                a = {};
+            }
+        };
+
+        using object_container = std::conditional_t<details::is_packed_storage<StoragePolicy>,
+                packed_object_container, vector_object_container>;
+
     private:
         using object_container_t = object_container;
 
         object_container objects;
 
+        //the live range of one invoke, ended even when a listener throws
+        class iteration_scope
+        {
+            object_container& objects;
+        public:
+            const decltype(std::declval<object_container&>().end()) end;
+
+            explicit iteration_scope(object_container& objects) : objects(objects), end(objects.end()) {}
+
+            iteration_scope(const iteration_scope&) = delete;
+
+            ~iteration_scope() { objects.release_removed(); }
+        };
+
+        //the live range walked out of order, removals are applied when the scope ends, even by an exception
+        class deferred_scope
+        {
+            object_container& objects;
+            typename object_container::deferred_removal state;
+        public:
+            const decltype(std::declval<object_container&>().end()) end;
+
+            deferred_scope(object_container& objects, bool concurrent)
+                    : objects(objects), state{concurrent, {}, {}}, end(objects.begin_deferred(state)) {}
+
+            deferred_scope(const deferred_scope&) = delete;
+
+            ~deferred_scope() { objects.release_deferred(); }
+        };
+        [[no_unique_address]] allocator_t allocator;
+
         template<typename T_ptr>
         using value_of = typename std::pointer_traits<T_ptr>::element_type;
     public:
         multicast_function() = default;
 
+        //every bound callable that overflows the small buffer is allocated from alloc
+        explicit multicast_function(const allocator_t& alloc) : objects(alloc), allocator(alloc) {}
+
         multicast_function(const multicast_function&) = delete;
 
         multicast_function(multicast_function&& other) noexcept = default;
 
-        auto size() { return objects.size(); }
+        auto size() { return objects.live_size(); }
+
+        //bytes of listener storage in use, callables boxed on the heap excluded
+        size_t memory_size() const { return objects.memory_size(); }
 
-        bool empty() { return objects.empty(); }
+        bool empty() { return objects.live_size() == 0; }
 
         void clear() { objects.clear(); }
 
+        allocator_t get_allocator() const { return allocator; }
+
+        //groups listeners of the same callable type so consecutive calls hit the same invoker
+        //unbinding moves the last listener into the hole, call it again once the listeners are settled, not from inside an invoke
+        void sort_by_invoker() requires (not object_container::ordered) { objects.sort_by_invoker(); }
+
+        //removes the weak listeners whose owner is gone, returns how many
+        //an invoke removes them as it meets them, sweeping between invokes keeps that off the dispatch
+        size_t remove_expired() requires requires(const function_t& f) { f.expired(); } { return objects.remove_expired(); }
+
     public:
 
-        using function_type = Ret(Args...);
-        using function_pointer = Ret(*)(Args...);
+        using function_type = Ret(Args...) noexcept(NoExcept);
+        using function_pointer = Ret(*)(Args...) noexcept(NoExcept);
 
         template<typename T_Ptr, auto MemFunc>
         struct member_func_wrapper
@@ -136,7 +734,7 @@ namespace auto_delegate
 
             explicit member_func_wrapper(const T_Ptr& obj) : obj(obj) {}
 
-            Ret operator()(Args... args)
+            Ret operator()(Args... args) noexcept(std::is_nothrow_invocable_v<decltype(MemFunc), const T_Ptr&, Args...>)
             {
                 return (obj->*MemFunc)(std::forward<Args>(args)...);
             }
@@ -152,16 +750,19 @@ namespace auto_delegate
             explicit object_lambda_extend_wrapper(T_Ptr obj, OtherLambda&& other)
                     : obj(obj), lambda(std::forward<OtherLambda>(other)) {}
 
-            Ret operator()(Args... args)
+            Ret operator()(Args... args) noexcept(std::is_nothrow_invocable_v<Lambda&, decltype(*obj), Args...>)
             {
                 return lambda(*obj, std::forward<Args>(args)...);
             }
         };
 
+        //copy constructible is only required when function_t is copyable
+        //a function_t is stored as it is, it keeps its own allocator
         template<typename Callable>
         static constexpr bool bindable = std::same_as<std::invoke_result_t<Callable, Args...>, Ret>
-                                         and std::move_constructible<Callable>
-                                         and std::copy_constructible<Callable>;
+                                         and (std::constructible_from<function_t, std::allocator_arg_t, const allocator_t&, Callable>
+                                              or (std::same_as<std::decay_t<Callable>, function_t>
+                                                  and std::constructible_from<function_t, Callable>));
 
 
         decltype(auto) notify_bind(auto& functor)
@@ -181,8 +782,15 @@ namespace auto_delegate
         decltype(auto) bind(Callable&& callable)
         {
             using callable_t = std::decay_t<Callable>;
-            auto& callee = (callable_t&) objects.emplace_back(function(std::forward<Callable>(callable)));
-            return notify_bind(callee);
+            if constexpr (std::same_as<callable_t, function_t> and not object_container::packed)
+            {
+                objects.emplace_back(std::forward<Callable>(callable));
+                return;
+            } else
+            {
+                auto& callee = (callable_t&) objects.emplace_back(std::allocator_arg, allocator, std::forward<Callable>(callable));
+                return notify_bind(callee);
+            }
         }
 
         //bind methods
@@ -204,7 +812,10 @@ namespace auto_delegate
         template<auto Func>
         decltype(auto) bind()
         {
-            return bind([](Args... args) -> Ret { return Func(std::forward<Args>(args)...); });
+            return bind([](Args... args) noexcept(std::is_nothrow_invocable_v<decltype(Func), Args...>) -> Ret
+                        {
+                            return Func(std::forward<Args>(args)...);
+                        });
         }
 
         //bind object with lambda
@@ -222,7 +833,10 @@ namespace auto_delegate
 
             handled_wrapper(Callable&& functor) : functor(std::forward<Callable>(functor)) {}
 
-            Ret operator()(Args... args) { return functor(std::forward<Args>(args)...); }
+            Ret operator()(Args... args) noexcept(std::is_nothrow_invocable_v<Callable&, Args...>)
+            {
+                return functor(std::forward<Args>(args)...);
+            }
 
             delegate_handle on_bind() { return delegate_handle(&inv_handle); }
         };
@@ -246,7 +860,10 @@ namespace auto_delegate
 
             unique_handled_wrapper(unique_handled_wrapper&&) = default;
 
-            Ret operator()(Args... args) { return functor(std::forward<Args>(args)...); }
+            Ret operator()(Args... args) noexcept(std::is_nothrow_invocable_v<Callable&, Args...>)
+            {
+                return functor(std::forward<Args>(args)...);
+            }
 
             auto on_bind(object_container_t* container)
             {
@@ -263,7 +880,10 @@ namespace auto_delegate
         {
             unique_delegate_handle_ref inv_handle{};
 
-            Ret operator()(Args... args) { return Func(std::forward<Args>(args)...); }
+            Ret operator()(Args... args) noexcept(std::is_nothrow_invocable_v<decltype(Func), Args...>)
+            {
+                return Func(std::forward<Args>(args)...);
+            }
 
             unique_handled_wrapper_static() = default;
 
@@ -299,7 +919,7 @@ namespace auto_delegate
         struct weak_ptr_wrapper_base
         {
             std::weak_ptr<T> obj;
-            object_container_t* conatiner;
+            object_container_t* conatiner = nullptr;
 
             template<typename T_ptr>
             requires std::same_as<value_of<std::decay_t<T_ptr>>, T>
@@ -310,11 +930,14 @@ namespace auto_delegate
                 this->conatiner = container;
             }
 
+            //one lock attempt per call, the owner is held for the duration of the call
             Ret _invoke(Args... args, auto&& invoker)
             {
-                if (obj.expired()) return conatiner->remove_on_call(this, std::forward<Args>(args)...);
-                return invoker(std::forward<Args>(args)...);
+                if (auto shared = obj.lock()) return invoker(shared.get(), std::forward<Args>(args)...);
+                return conatiner->remove_on_call(this, std::forward<Args>(args)...);
             }
+
+            bool expired() const noexcept { return obj.expired(); }
         };
 
 
@@ -324,12 +947,12 @@ namespace auto_delegate
             using super = weak_ptr_wrapper_base<T>;
             using super::super;
 
-            Ret operator()(Args... args)
+            Ret operator()(Args... args) noexcept(std::is_nothrow_invocable_v<decltype(MemFunc), T*, Args...>)
             {
                 return super::_invoke(std::forward<Args>(args)...,
-                                      [&](Args... args_)
+                                      [](T* o, Args... args_)
                                       {
-                                          return (this->obj.lock().get()->*MemFunc)(std::forward<Args>(args_)...);
+                                          return (o->*MemFunc)(std::forward<Args>(args_)...);
                                       });
 
             }
@@ -346,12 +969,12 @@ namespace auto_delegate
             explicit weak_ptr_wrapper_lambda(const T_Ptr& obj, OtherLambda&& other)
                     : super(obj), lambda(std::forward<OtherLambda>(other)) {}
 
-            Ret operator()(Args... args)
+            Ret operator()(Args... args) noexcept(std::is_nothrow_invocable_v<Lambda&, T&, Args...>)
             {
                 return super::_invoke(std::forward<Args>(args)...,
-                                      [&](Args... args_)
+                                      [&](T* o, Args... args_)
                                       {
-                                          return lambda(*this->obj.lock().get(), std::forward<Args>(args_)...);
+                                          return lambda(*o, std::forward<Args>(args_)...);
                                       });
 
             }
@@ -394,48 +1017,152 @@ namespace auto_delegate
 
     public:
         //no need to forward as the parameters types are already defined
-        void invoke(Args... args) requires std::same_as<Ret, void>
+        void invoke(Args... args) noexcept(NoExcept) requires std::same_as<Ret, void>
         {
             auto iter = objects.begin();
-            auto& end = objects.end();
+            iteration_scope scope(objects);
             //require iter < end there in call remove and ++iter get iterator out of range
-            for (; iter < end; ++iter)
+            for (; iter < scope.end; ++iter)
             {
                 auto& functor = *iter;
                 functor(std::forward<Args>(args)...);
             }
-            objects.release_removed();
         }
 
-        void operator()(Args... args) requires std::same_as<Ret, void>
+        void operator()(Args... args) noexcept(NoExcept) requires std::same_as<Ret, void>
         {
             invoke(std::forward<Args>(args)...);
         }
 
+        //listeners are split in chunks run concurrently by the executor, expired ones are removed after all chunks are done
+        //binding, unbinding or invoking the same multicast_function from a listener meanwhile is not supported
+        template<bulk_executor Executor>
+        void parallel_invoke(Executor&& executor, parallel_grain grain, Args... args)
+        requires std::same_as<Ret, void> and (not object_container::packed)
+        {
+            auto first = objects.begin();
+            deferred_scope scope(objects, true);
+            details::parallel_for_chunks(executor, first, size_t(scope.end - first), grain, [&](size_t, auto it, auto last)
+            {
+                for (; it != last; ++it)
+                {
+                    auto& functor = *it;
+                    functor(args...);
+                }
+            });
+        }
+
+        template<bulk_executor Executor>
+        void parallel_invoke(Executor&& executor, Args... args)
+        requires std::same_as<Ret, void> and (not object_container::packed)
+        {
+            parallel_invoke(executor, parallel_grain{}, args...);
+        }
+
+        //each chunk folds its results from identity, the partial results are then reduced in listener order
+        template<bulk_executor Executor, typename T, typename Reduce>
+        requires (!std::same_as<Ret, void>) and (not object_container::packed)
+                 and std::is_invocable_r_v<T, Reduce&, T, Ret> and std::is_invocable_r_v<T, Reduce&, T, T>
+        T parallel_invoke(Executor&& executor, parallel_grain grain, T identity, Reduce&& reduce, Args... args)
+        {
+            std::vector<T> partial;
+            {
+                auto first = objects.begin();
+                deferred_scope scope(objects, true);
+                size_t count = scope.end - first;
+                partial.resize(details::chunk_count<function_t>(count, grain), identity);
+                details::parallel_for_chunks(executor, first, count, grain, [&](size_t chunk_index, auto it, auto last)
+                {
+                    T result = identity;
+                    for (; it != last; ++it)
+                    {
+                        auto& functor = *it;
+                        Ret&& ret = functor(args...);
+                        if (std::exchange(objects.fake_return, false)) continue;//fake return
+                        result = reduce(std::move(result), std::forward<Ret>(ret));
+                    }
+                    partial[chunk_index] = std::move(result);
+                });
+            }
+            for (auto& p: partial)
+                identity = reduce(std::move(identity), std::move(p));
+            return identity;
+        }
+
+        template<bulk_executor Executor, typename T, typename Reduce>
+        requires (!std::same_as<Ret, void>) and (not object_container::packed)
+                 and std::is_invocable_r_v<T, Reduce&, T, Ret> and std::is_invocable_r_v<T, Reduce&, T, T>
+        T parallel_invoke(Executor&& executor, T identity, Reduce&& reduce, Args... args)
+        {
+            return parallel_invoke(executor, parallel_grain{}, std::move(identity), std::forward<Reduce>(reduce), args...);
+        }
+
+        //listener major, every listener handles the whole batch before the next one is called
+        //expired listeners are removed after the batch, binds made meanwhile are queued as in invoke
+        void invoke_batch(std::span<const std::tuple<Args...>> batch) noexcept(NoExcept) requires std::same_as<Ret, void>
+        {
+            //from inside a listener the live range is already walked, the packs are dispatched one by one as nested invokes
+            if (objects.nesting)
+            {
+                for (auto& args: batch)
+                    std::apply([&](auto& ... a) { invoke(a...); }, args);
+                return;
+            }
+            auto iter = objects.begin();
+            deferred_scope scope(objects, false);
+            for (; iter < scope.end; ++iter)
+            {
+                auto& functor = *iter;
+                if constexpr (requires { functor.invoke_batch(batch); })
+                    functor.invoke_batch(batch);
+                else
+                    for (auto& args: batch)
+                        std::apply([&](auto& ... a) { functor(a...); }, args);
+            }
+        }
+
         template<typename Callable>
         requires (!std::same_as<Ret, void>)
         void for_each_invoke(Args... args, Callable&& result_proc)
         {
             auto iter = objects.begin();
-            auto& end = objects.end();
+            iteration_scope scope(objects);
             //require iter < end there in call remove and ++iter get iterator out of range
-            for (; iter < end; iter++)
+            for (; iter < scope.end; iter++)
             {
                 auto& functor = *iter;
                 Ret&& ret = functor(std::forward<Args>(args)...);
-                if (iter == end) break;//fake return
+                if (std::exchange(objects.fake_return, false)) continue;//fake return
                 result_proc(std::forward<Ret>(ret));
             }
-            objects.release_removed();
+        }
+
+        //folds the results through a combiner from auto_delegate::combiners, stops early once it has its answer
+        template<typename Combiner>
+        requires (!std::same_as<Ret, void>) and result_combiner<std::decay_t<Combiner>, Ret>
+        auto combine(Combiner&& combiner, Args... args)
+        {
+            return details::combine<Ret>(combiner, [&](auto&& push)
+            {
+                auto iter = objects.begin();
+                iteration_scope scope(objects);
+                for (; iter < scope.end; ++iter)
+                {
+                    auto& functor = *iter;
+                    Ret ret = functor(args...);
+                    if (std::exchange(objects.fake_return, false)) continue;//fake return
+                    if (!push(std::move(ret))) break;
+                }
+            });
         }
 
         template<typename Callable>
         void for_each(Callable&& func) requires std::same_as<Ret, void>
         {
             auto iter = objects.begin();
-            auto& end = objects.end();
+            iteration_scope scope(objects);
             //require iter < end there in call remove and ++iter get iterator out of range
-            for (; iter < end; iter++)
+            for (; iter < scope.end; iter++)
             {
                 auto& functor = *iter;
                 bool fake_return = false;
@@ -443,11 +1170,9 @@ namespace auto_delegate
                      {
                          if (fake_return) return;
                          functor(std::forward<Args>(args)...);
-                         if (iter == end) fake_return = true;//fake invoke
+                         if (std::exchange(objects.fake_return, false)) fake_return = true;//fake invoke
                      });
             }
-
-            objects.release_removed();
         }
 
         //the call need to be interrupt when the second is true
@@ -455,18 +1180,18 @@ namespace auto_delegate
         void for_each(Callable&& func) requires (!std::same_as<Ret, void>)
         {
             auto iter = objects.begin();
-            auto& end = objects.end();
+            iteration_scope scope(objects);
             //require iter < end there in call remove and ++iter get iterator out of range
-            for (; iter < end; iter++)
+            for (; iter < scope.end; iter++)
             {
                 auto& functor = *iter;
                 bool fake_return = false;
                 func([&](Args... args) mutable
                      {
-                         return std::pair<Ret, bool>(functor(std::forward<Args>(args)...), iter == end);
+                         Ret ret = functor(std::forward<Args>(args)...);
+                         return std::pair<Ret, bool>(std::move(ret), std::exchange(objects.fake_return, false));
                      });
             }
-            objects.release_removed();
         }
     };
 
@@ -502,7 +1227,7 @@ namespace auto_delegate
     {
         member_func_wrapper(ObjectBinder&& obj) : ObjectBinder(std::move(obj)) {}
 
-        Ret operator()(Args... args)
+        Ret operator()(Args... args) noexcept(std::is_nothrow_invocable_v<decltype(Memfunc), T*, Args...>)
         {
             return this->invoke([](auto&& ptr, Args... args_)
                                 {
@@ -548,7 +1273,7 @@ namespace auto_delegate
         bind_into_lambda_warpper(ObjectBinder&& obj, Lambda&& lambda)
                 : ObjectBinder(std::move(obj)), lambda(std::move(lambda)) {}
 
-        Ret operator()(Args... args)
+        Ret operator()(Args... args) noexcept(std::is_nothrow_invocable_v<Lambda&, T&, Args...>)
         {
             // return ObjectBinder::invoke(lambda, std::forward<decltype(args)>(args)...);
             return ObjectBinder::invoke([&](auto&& ptr, Args...args)
@@ -663,12 +1388,14 @@ namespace auto_delegate
 
         unique_handled_wrapper(unique_handled_wrapper&&) = default;
 
-        Ret operator()(Args... args)
+        Ret operator()(Args... args) noexcept(std::is_nothrow_invocable_v<Callable&, Args...>)
         {
             auto& functor = copy_wrapper.functor;
             return functor(std::forward<Args>(args)...);
         }
 
+        bool expired() const noexcept requires expirable<Callable> { return copy_wrapper.functor.expired(); }
+
         template<typename Container>
         auto on_bind(Container* container)
         {
@@ -723,12 +1450,14 @@ namespace auto_delegate
             };
         }
 
+        //one lock attempt per call, the owner is held for the duration of the call
         Ret invoke(auto&& invoker, Args... args)
         {
-            if (obj.expired()) return on_expired(this, std::forward<Args>(args)...);
-            auto shared = obj.lock();
-            return invoker(shared.get(), std::forward<Args>(args)...);
+            if (auto shared = obj.lock()) return invoker(shared.get(), std::forward<Args>(args)...);
+            return on_expired(this, std::forward<Args>(args)...);
         }
+
+        bool expired() const noexcept { return obj.expired(); }
     };
 
     template<typename T_Ptr>
@@ -797,4 +1526,21 @@ namespace auto_delegate
 }
 
 
+namespace auto_delegate::pmr
+{
+    template<typename Func>
+    using multicast_function = auto_delegate::multicast_function<Func, pmr::function<Func>>;
+}
+
+namespace auto_delegate
+{
+    //listeners are called in bind order, unbinding leaves a tombstone compacted in bulk
+    template<typename Func, typename Function = function<Func>>
+    using multicast_ordered_function = multicast_function<Func, Function, ordered_removal<>>;
+
+    //listeners are packed at their own size and called in bind order
+    template<typename Func, typename Function = function<Func>>
+    using multicast_packed_function = multicast_function<Func, Function, packed_storage<>>;
+}
+
 #undef no_unique_address
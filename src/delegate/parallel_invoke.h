@@ -0,0 +1,70 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <numeric>
+#include "function_ref.h"
+
+namespace auto_delegate
+{
+    //runs task(i) for every i in [0, task_count) and returns once all of them are done
+    //tasks may run concurrently, a work stealing pool is the intended implementation
+    template<typename Executor>
+    concept bulk_executor = requires(Executor& executor, size_t task_count, function_ref<void(size_t)> task)
+    {
+        executor.bulk_execute(task_count, task);
+    };
+
+    //runs every task on the calling thread
+    struct inline_executor
+    {
+        void bulk_execute(size_t task_count, function_ref<void(size_t)> task) const
+        {
+            for (size_t i = 0; i < task_count; ++i)
+                task(i);
+        }
+    };
+
+    //listeners invoked by one task
+    struct parallel_grain
+    {
+        size_t size = 1024;
+    };
+
+    namespace details
+    {
+        inline constexpr size_t cache_line_size = 64;
+
+        //the grain rounded up so a chunk of T spans whole cache lines
+        template<typename T>
+        constexpr size_t chunk_size(parallel_grain grain)
+        {
+            constexpr size_t unit = cache_line_size / std::gcd(sizeof(T), cache_line_size);
+            return (std::max<size_t>(grain.size, 1) + unit - 1) / unit * unit;
+        }
+
+        template<typename T>
+        constexpr size_t chunk_count(size_t count, parallel_grain grain)
+        {
+            const size_t chunk = chunk_size<T>(grain);
+            return (count + chunk - 1) / chunk;
+        }
+
+        //calls fn(chunk_index, first, last) for every chunk of [begin, begin + count) through the executor
+        template<typename Iterator, typename Executor, typename Fn>
+        void parallel_for_chunks(Executor& executor, Iterator begin, size_t count, parallel_grain grain, Fn&& fn)
+        {
+            using value_t = std::decay_t<decltype(*begin)>;
+            const size_t chunk = chunk_size<value_t>(grain);
+            const size_t task_count = chunk_count<value_t>(count, grain);
+            if (task_count == 0) return;
+            executor.bulk_execute(task_count, [&](size_t index)
+            {
+                size_t first = index * chunk;
+                size_t last = std::min(count, first + chunk);
+                fn(index, begin + first, begin + last);
+            });
+        }
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#if defined(_MSC_VER) && !defined(__clang__)
+#if defined(_M_IX86) || defined(_M_X64)
+#include <xmmintrin.h>
+#else
+#include <intrin.h>
+#endif
+#endif
+
+namespace auto_delegate
+{
+    //how far ahead of the listener being called the next objects are prefetched
+    struct prefetch_distance
+    {
+        size_t listeners = 8;
+        //also prefetch the invoker, worth it once the targets no longer fit in the instruction cache
+        bool invoker = false;
+    };
+
+    namespace details
+    {
+        //a hint only, null or dangling addresses do not fault
+        inline void prefetch_read(const void* address) noexcept
+        {
+#if defined(_MSC_VER) && !defined(__clang__)
+#if defined(_M_IX86) || defined(_M_X64)
+            _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#else
+            __prefetch(address);
+#endif
+#else
+            __builtin_prefetch(address, 0, 3);
+#endif
+        }
+    }
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cassert>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "multicast_delegate.h"
+#include "multicast_function.h"
+
+namespace auto_delegate
+{
+    //records the argument packs of events and dispatches them together at flush
+    //binding and the immediate invoke are those of the underlying multicast
+    template<typename Func, typename Multicast = multicast_delegate<Func>>
+    class queued_multicast;
+
+    template<typename Ret, typename... Args, bool NoExcept, typename Multicast>
+    class queued_multicast<Ret(Args...) noexcept(NoExcept), Multicast> : public Multicast
+    {
+    public:
+        //the arguments are stored by value, a reference parameter refers to the queued copy during the flush
+        using event_t = std::tuple<std::remove_cvref_t<Args>...>;
+
+    private:
+        //events are appended to pending, flush swaps it with dispatching so that the listeners can enqueue meanwhile
+        //both buffers keep their capacity, once warmed up an enqueue does not allocate
+        std::vector<event_t> pending;
+        std::vector<event_t> dispatching;
+        bool flushing = false;
+
+        //clears the dispatched events even when a listener throws
+        struct flush_scope
+        {
+            queued_multicast& self;
+
+            explicit flush_scope(queued_multicast& self) : self(self)
+            {
+                self.flushing = true;
+                std::swap(self.pending, self.dispatching);
+            }
+
+            ~flush_scope()
+            {
+                self.dispatching.clear();
+                self.flushing = false;
+            }
+        };
+
+        void dispatch(event_t& event)
+        {
+            Multicast& multicast = *this;
+            std::apply([&](auto& ... a)
+            {
+                if constexpr (std::same_as<Ret, void>)
+                    multicast.invoke(std::forward<Args>(a)...);
+                else
+                    multicast.for_each_invoke(std::forward<Args>(a)..., [](auto&&) {});
+            }, event);
+        }
+
+    public:
+        using Multicast::Multicast;
+
+        template<typename... T>
+        requires std::constructible_from<event_t, T&&...>
+        void enqueue(T&& ... args)
+        {
+            pending.emplace_back(std::forward<T>(args)...);
+        }
+
+        size_t queued() const { return pending.size(); }
+
+        void reserve(size_t count) { pending.reserve(count); }
+
+        void discard() { pending.clear(); }
+
+        //dispatches the queued events in enqueue order, each one to every listener
+        //events enqueued by the listeners are left for the next flush, a flush from a listener does nothing
+        void flush() noexcept(NoExcept)
+        {
+            if (flushing) return;
+            flush_scope scope(*this);
+            for (auto& event: dispatching)
+                dispatch(event);
+        }
+
+        //listener major, every listener handles all the queued events before the next one is called
+        //only for value parameters, as the batch is handed to the listeners as it is stored
+        void flush_batch() noexcept(NoExcept)
+        requires std::same_as<Ret, void> and std::same_as<event_t, std::tuple<Args...>>
+                 and requires(Multicast& m, std::span<const event_t> batch) { m.invoke_batch(batch); }
+        {
+            if (flushing) return;
+            flush_scope scope(*this);
+            Multicast::invoke_batch(std::span<const event_t>(dispatching));
+        }
+    };
+
+    template<typename Func>
+    using queued_multicast_function = queued_multicast<Func, multicast_function<Func>>;
+}
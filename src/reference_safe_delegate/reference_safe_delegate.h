@@ -416,6 +416,8 @@ namespace auto_delegate
             if (!ref) return on_expired(this, std::forward<Args>(args)...);
             return invoker(ref.get() ,std::forward<Args>(args)...);
         }
+
+        bool expired() const noexcept { return !ref; }
     };
 
     template<typename T_Ptr>
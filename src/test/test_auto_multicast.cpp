@@ -1,7 +1,9 @@
 #include "../reference_safe_delegate/reference_safe_delegate.h"
+#include "../delegate/queued_multicast.h"
 #include <gtest/gtest.h>
 
 #include <random>
+#include <thread>
 #include <iostream>
 
 using namespace auto_delegate;
@@ -415,6 +417,498 @@ TEST(auto_multicast, unique_handle)
     delete a;
 }
 
+TEST(auto_multicast, prefetch_invoke)
+{
+    using namespace test_multicast;
+    using A = multicast_auto_delegate<void(ARG_LIST)>;
+
+    A a;
+    std::vector<B*> objects;
+    for (int i = 0; i < 12; ++i)
+    {
+        objects.push_back(new B("b" + std::to_string(i)));
+        a.bind<B, &B::action>(objects.back());
+    }
+
+    //listeners destroyed before the invoke are neither prefetched nor called
+    delete objects[4];
+    delete objects[11];
+    uint64_t expected = 0;
+    for (int i = 0; i < 12; ++i)
+        if (i != 4 and i != 11) expected += objects[i]->hash();
+
+    for (prefetch_distance distance: {prefetch_distance{}, prefetch_distance{2, true}, prefetch_distance{64}})
+    {
+        invoke_hash = 0;
+        a.prefetch_invoke(distance, PARAM_LIST);
+        ASSERT_EQ(invoke_hash, expected);
+    }
+
+    for (int i = 0; i < 12; ++i)
+        if (i != 4 and i != 11) delete objects[i];
+    ASSERT_TRUE(a.empty());
+}
+
+namespace test_posted
+{
+    struct throwing_copy
+    {
+        throwing_copy() = default;
+
+        throwing_copy(const throwing_copy&) {}
+    };
+
+    struct listener : mailbox_affinity
+    {
+        using mailbox_affinity::mailbox_affinity;
+
+        void on_int(int) noexcept {}
+
+        void on_copy(const throwing_copy&) noexcept {}
+    };
+
+    template<typename Event, auto MemFunc>
+    concept postable = requires(Event& event, listener* obj) { event.template bind_posted<MemFunc>(obj); };
+
+    //a noexcept event only posts arguments whose copy can not throw, the listener itself takes a reference
+    static_assert(postable<multicast_delegate<void(int) noexcept>, &listener::on_int>);
+    static_assert(postable<multicast_delegate<void(const throwing_copy&)>, &listener::on_copy>);
+    static_assert(not postable<multicast_delegate<void(const throwing_copy&) noexcept>, &listener::on_copy>);
+}
+
+TEST(auto_multicast, posted_invoke)
+{
+    using namespace test_multicast;
+    using A = multicast_auto_delegate<void(ARG_LIST)>;
+
+    struct P : generic_ref_reflector, mailbox_affinity
+    {
+        uint64_t id;
+        std::thread::id caller;
+
+        P(mailbox& box, uint64_t id) : mailbox_affinity(box), id(id) {}
+
+        void action(ARG_LIST) noexcept
+        {
+            invoke_hash += id;
+            caller = std::this_thread::get_id();
+            assert(t1 == params.v1);
+            assert(t2 == params.v2);
+            assert(t1c == params.v3);
+            assert(t2c == params.v4);
+        }
+    };
+
+    mailbox box;
+    A a;
+    std::vector<P*> objects;
+    for (uint64_t i = 0; i < 4; ++i)
+    {
+        objects.push_back(new P(box, 1ull << i));
+        a.bind_posted<P, &P::action>(objects.back());
+    }
+
+    invoke_hash = 0;
+    std::thread poster([&]
+    {
+        a.invoke(PARAM_LIST);
+        a.invoke(PARAM_LIST);
+    });
+    poster.join();
+    ASSERT_EQ(invoke_hash, 0);
+    ASSERT_FALSE(box.empty());
+
+    //destroyed before the drain, its posted calls are skipped
+    delete objects[2];
+    ASSERT_EQ(a.size(), 3);
+    ASSERT_EQ(box.drain(), 8);
+    ASSERT_EQ(invoke_hash, 2 * (1 + 2 + 8));
+    ASSERT_TRUE(box.empty());
+    for (int i: {0, 1, 3})
+        ASSERT_EQ(objects[i]->caller, std::this_thread::get_id());
+
+    ASSERT_EQ(box.drain(), 0);
+    for (int i: {0, 1, 3}) delete objects[i];
+    ASSERT_TRUE(a.empty());
+}
+
+namespace test_slot_map
+{
+    struct counter
+    {
+        std::vector<int>* calls;
+        int id;
+
+        void add(int) { calls->push_back(id); }
+    };
+
+    template<typename Event>
+    void handles()
+    {
+        using handle_t = typename Event::delegate_handle_t;
+        std::vector<int> calls;
+        std::vector<counter> counters;
+        for (int i = 0; i < 100; ++i) counters.push_back({&calls, i});
+        auto called = [&](auto& event)
+        {
+            calls.clear();
+            event(0);
+            std::sort(calls.begin(), calls.end());
+            return calls;
+        };
+
+        std::optional<Event> event(std::in_place);
+        std::vector<handle_t> handles;
+        //growth relocates the listeners, the handles are not touched
+        for (auto& c: counters) handles.push_back(event->template bind<&counter::add>(&c));
+        for (auto& h: handles) ASSERT_TRUE(h.valid());
+
+        std::vector<int> expected;
+        for (int i = 0; i < 100; ++i)
+        {
+            if (i % 3 == 0) handles[i].unbind();
+            else expected.push_back(i);
+        }
+        ASSERT_FALSE(handles[0].valid());
+        ASSERT_TRUE(handles[1].valid());
+        ASSERT_EQ(event->size(), expected.size());
+        ASSERT_EQ(called(*event), expected);
+
+        //the slot of an unbound listener is reused with a new generation
+        handles[0] = event->template bind<&counter::add>(&counters[0]);
+        ASSERT_TRUE(handles[0].valid());
+        expected.insert(expected.begin(), 0);
+        ASSERT_EQ(called(*event), expected);
+
+        //handles follow a moved container
+        Event moved(std::move(*event));
+        handles[1].unbind();
+        moved.unbind(handles[2]);
+        expected.erase(expected.begin() + 1, expected.begin() + 3);
+        ASSERT_EQ(called(moved), expected);
+
+        //released handles keep their listener, handles outlive the container
+        handles[4].release();
+        moved.clear();
+        ASSERT_TRUE(moved.empty());
+        ASSERT_FALSE(handles[5].valid());
+        handles.push_back(moved.template bind<&counter::add>(&counters[0]));
+        handles.push_back(moved.template bind<&counter::add>(&counters[1]));
+        handles[handles.size() - 2].release();
+        ASSERT_EQ(called(moved), (std::vector<int>{0, 1}));
+        //stale handles of the cleared listeners do not remove the ones reusing their slots
+        for (size_t i = 5; i < 100; ++i) handles[i].unbind();
+        ASSERT_EQ(called(moved), (std::vector<int>{0, 1}));
+        event.reset();
+        {
+            Event gone(std::move(moved));
+        }
+        ASSERT_FALSE(handles.back().valid());
+    }
+}
+
+TEST(auto_multicast, slot_map_handle)
+{
+    using namespace test_slot_map;
+    handles<multicast_slot_map_delegate<void(int)>>();
+    handles<multicast_delegate<void(int), slot_map_delegate_container<ordered_removal<>>>>();
+
+    //bind order is kept by the ordered removal
+    std::vector<int> calls;
+    std::vector<counter> counters;
+    for (int i = 0; i < 10; ++i) counters.push_back({&calls, i});
+    multicast_delegate<void(int), slot_map_delegate_container<ordered_removal<>>> d;
+    std::vector<std::optional<decltype(d)::delegate_handle_t>> d_handles;
+    for (auto& c: counters) d_handles.emplace_back(d.bind<&counter::add>(&c));
+    for (int i: {0, 3, 4, 8}) d_handles[i].reset();
+    d(0);
+    ASSERT_EQ(calls, (std::vector<int>{1, 2, 5, 6, 7, 9}));
+    ASSERT_TRUE(d_handles[9]->valid());
+    d_handles[9].reset();
+    d_handles[1].reset();
+    calls.clear();
+    d(0);
+    ASSERT_EQ(calls, (std::vector<int>{2, 5, 6, 7}));
+}
+
+namespace test_soa
+{
+    struct counter
+    {
+        std::vector<int>* calls;
+        int id;
+
+        void add(int) { calls->push_back(id); }
+
+        void add_twice(int) { calls->push_back(id + 100); }
+
+        int get(int v) { return id + v; }
+    };
+
+    template<typename Event>
+    void unbind()
+    {
+        std::vector<int> calls;
+        std::vector<counter> counters;
+        for (int i = 0; i < 50; ++i) counters.push_back({&calls, i});
+        auto called = [&](auto& event)
+        {
+            calls.clear();
+            event(0);
+            std::sort(calls.begin(), calls.end());
+            return calls;
+        };
+
+        Event event;
+        std::vector<std::optional<typename Event::delegate_handle_t>> handles;
+        for (auto& c: counters) handles.emplace_back(event.template bind<&counter::add>(&c));
+        std::vector<int> expected;
+        for (int i = 0; i < 50; ++i)
+        {
+            if (i % 3 == 0) handles[i].reset();
+            else expected.push_back(i);
+        }
+        ASSERT_EQ(event.size(), expected.size());
+        ASSERT_EQ(called(event), expected);
+
+        //the arrays stay in step, the remaining handles still remove their own listener
+        Event moved(std::move(event));
+        for (int i: {1, 2, 49}) handles[i].reset();
+        std::erase_if(expected, [](int i) { return i == 1 or i == 2 or i == 49; });
+        ASSERT_EQ(called(moved), expected);
+        handles.clear();
+        ASSERT_TRUE(moved.empty());
+    }
+}
+
+TEST(auto_multicast, soa_container)
+{
+    using namespace test_soa;
+    unbind<multicast_soa_delegate<void(int)>>();
+    unbind<multicast_delegate<void(int), soa_delegate_container<ordered_removal<>>>>();
+
+    std::vector<int> calls;
+    std::vector<counter> counters;
+    for (int i = 0; i < 10; ++i) counters.push_back({&calls, i});
+
+    //bind order is kept by the ordered removal
+    multicast_delegate<void(int), soa_delegate_container<ordered_removal<>>> ordered;
+    std::vector<std::optional<decltype(ordered)::delegate_handle_t>> ordered_handles;
+    for (auto& c: counters) ordered_handles.emplace_back(ordered.bind<&counter::add>(&c));
+    for (int i: {0, 3, 4, 8}) ordered_handles[i].reset();
+    ordered(0);
+    ASSERT_EQ(calls, (std::vector<int>{1, 2, 5, 6, 7, 9}));
+
+    //listeners of the same invoker are grouped
+    multicast_soa_delegate<void(int)> grouped;
+    std::vector<std::optional<multicast_soa_delegate<void(int)>::delegate_handle_t>> grouped_handles;
+    for (auto& c: counters)
+    {
+        if (c.id % 2) grouped_handles.emplace_back(grouped.bind<&counter::add>(&c));
+        else grouped_handles.emplace_back(grouped.bind<&counter::add_twice>(&c));
+    }
+    grouped.sort_by_invoker();
+    calls.clear();
+    grouped(0);
+    ASSERT_EQ(calls.size(), 10);
+    bool first_group = calls.front() >= 100;
+    ASSERT_TRUE(std::is_partitioned(calls.begin(), calls.end(), [&](int v) { return (v >= 100) == first_group; }));
+    grouped_handles[4].reset();
+    calls.clear();
+    grouped(0);
+    ASSERT_EQ(calls.size(), 9);
+
+    //random access for the parallel fan out
+    multicast_soa_delegate<int(int)> sum;
+    std::vector<multicast_soa_delegate<int(int)>::delegate_handle_t> sum_handles;
+    for (auto& c: counters) sum_handles.push_back(sum.bind<&counter::get>(&c));
+    ASSERT_EQ(sum.parallel_invoke(inline_executor{}, parallel_grain{2}, 0, std::plus<>(), 1), 55);
+}
+
+namespace test_grouped
+{
+    template<int I>
+    struct listener
+    {
+        std::vector<int>* calls;
+        int id;
+
+        void on(int v) { calls->push_back(I * 1000 + id + v); }
+
+        int get(int v) { return I * 1000 + id + v; }
+    };
+}
+
+TEST(auto_multicast, grouped_container)
+{
+    using namespace test_grouped;
+    std::vector<int> calls;
+    std::vector<listener<1>> first;
+    std::vector<listener<2>> second;
+    for (int i = 0; i < 20; ++i)
+    {
+        first.push_back({&calls, i});
+        second.push_back({&calls, i});
+    }
+
+    multicast_grouped_delegate<void(int)> a;
+    std::vector<std::optional<multicast_grouped_delegate<void(int)>::delegate_handle_t>> handles;
+    std::vector<int> expected;
+    for (int i = 0; i < 20; ++i)
+    {
+        handles.emplace_back(a.bind<&listener<1>::on>(&first[i]));
+        handles.emplace_back(a.bind<&listener<2>::on>(&second[i]));
+        expected.push_back(1000 + i);
+        expected.push_back(2000 + i);
+    }
+    handles.emplace_back(a.bind([](int) {}));
+    //one bucket per invoker
+    ASSERT_EQ(a.size(), 41);
+    auto called = [&](auto& event)
+    {
+        calls.clear();
+        event(0);
+        std::sort(calls.begin(), calls.end());
+        return calls;
+    };
+    //the buckets are called in the order they were created, each in bind order
+    calls.clear();
+    a(0);
+    ASSERT_TRUE(std::is_sorted(calls.begin(), calls.end()));
+    std::sort(expected.begin(), expected.end());
+    ASSERT_EQ(calls, expected);
+
+    //unbinding keeps the buckets of the other listeners, an emptied bucket is dropped
+    for (int i = 0; i < 20; ++i)
+    {
+        if (i % 4) continue;
+        handles[i * 2].reset();
+        std::erase(expected, 1000 + i);
+    }
+    handles.back().reset();
+    for (int i = 0; i < 20; ++i)
+    {
+        handles[i * 2 + 1].reset();
+        std::erase(expected, 2000 + i);
+    }
+    ASSERT_EQ(a.size(), expected.size());
+    ASSERT_EQ(called(a), expected);
+
+    //the emptied bucket is created again behind the remaining one
+    handles.emplace_back(a.bind<&listener<2>::on>(&second[0]));
+    calls.clear();
+    a(0);
+    ASSERT_EQ(calls.back(), 2000);
+    ASSERT_EQ(calls.size(), expected.size() + 1);
+    handles.back().reset();
+
+    //handles follow the moved container
+    multicast_grouped_delegate<void(int)> moved(std::move(a));
+    handles[2].reset();
+    std::erase(expected, 1001);
+    ASSERT_EQ(called(moved), expected);
+    handles.clear();
+    ASSERT_TRUE(moved.empty());
+
+    //the last bucket fills the hole of an emptied one, its handles still find it
+    multicast_grouped_delegate<void(int)> c;
+    auto c_first = c.bind<&listener<1>::on>(&first[0]);
+    auto c_second = c.bind<&listener<2>::on>(&second[0]);
+    listener<3> third{&calls, 0};
+    auto c_third = c.bind<&listener<3>::on>(&third);
+    c_first.unbind();
+    ASSERT_EQ(called(c), (std::vector<int>{2000, 3000}));
+    auto c_refilled = c.bind<&listener<1>::on>(&first[1]);
+    c_third.unbind();
+    c_second.unbind();
+    ASSERT_EQ(called(c), (std::vector<int>{1001}));
+    c_refilled.unbind();
+    ASSERT_TRUE(c.empty());
+
+    //calls with a result walk the buckets one listener at a time
+    multicast_grouped_delegate<int(int)> b;
+    std::vector<multicast_grouped_delegate<int(int)>::delegate_handle_t> b_handles;
+    for (int i = 0; i < 3; ++i)
+    {
+        b_handles.push_back(b.bind<&listener<1>::get>(&first[i]));
+        b_handles.push_back(b.bind<&listener<2>::get>(&second[i]));
+    }
+    int sum = 0;
+    b.for_each_invoke(1, [&](int r) { sum += r; });
+    ASSERT_EQ(sum, 3 * (1000 + 2000) + 2 * (0 + 1 + 2) + 6 * 1);
+}
+
+TEST(auto_multicast, container_prefetch_invoke)
+{
+    struct counter
+    {
+        int* sum;
+        int id;
+
+        void add(int v) { *sum += id * v; }
+    };
+    int sum = 0;
+    std::vector<counter> counters;
+    for (int i = 0; i < 20; ++i) counters.push_back({&sum, i});
+
+    auto check = [&]<typename Event>(std::type_identity<Event>)
+    {
+        Event a;
+        std::vector<std::optional<typename Event::delegate_handle_t>> handles;
+        for (auto& c: counters) handles.emplace_back(a.template bind<&counter::add>(&c));
+        handles[3].reset();
+        handles[19].reset();
+        const int expected = 190 - 3 - 19;
+        //shorter, longer than the listeners and no look ahead all call every listener once
+        for (prefetch_distance distance: {prefetch_distance{}, prefetch_distance{0, true}, prefetch_distance{100, true}})
+        {
+            sum = 0;
+            a.prefetch_invoke(distance, 1);
+            ASSERT_EQ(sum, expected);
+        }
+    };
+    check(std::type_identity<multicast_delegate<void(int)>>{});
+    check(std::type_identity<multicast_ordered_delegate<void(int)>>{});
+    check(std::type_identity<multicast_slot_map_delegate<void(int)>>{});
+    check(std::type_identity<multicast_grouped_delegate<void(int)>>{});
+}
+
+TEST(auto_multicast, queued_multicast)
+{
+    struct recorder
+    {
+        std::vector<std::pair<int, int>>* log;
+        int id;
+
+        void on_event(int v) { log->emplace_back(id, v); }
+    };
+    std::vector<std::pair<int, int>> log;
+    recorder r0{&log, 0}, r1{&log, 1};
+
+    queued_multicast<void(int)> a;
+    auto h0 = a.bind<&recorder::on_event>(&r0);
+    auto h1 = a.bind<&recorder::on_event>(&r1);
+    a.enqueue(1);
+    a.enqueue(2);
+    ASSERT_EQ(a.queued(), 2);
+    ASSERT_TRUE(log.empty());
+    a.flush();
+    ASSERT_EQ(log, (std::vector<std::pair<int, int>>{{0, 1}, {1, 1}, {0, 2}, {1, 2}}));
+    ASSERT_EQ(a.queued(), 0);
+
+    log.clear();
+    a.enqueue(3);
+    a.enqueue(4);
+    a.flush_batch();
+    ASSERT_EQ(log, (std::vector<std::pair<int, int>>{{0, 3}, {0, 4}, {1, 3}, {1, 4}}));
+
+    log.clear();
+    a.enqueue(5);
+    a.discard();
+    a.flush();
+    ASSERT_TRUE(log.empty());
+}
+
 #undef ARG_LIST
 #undef ARG_LIST_FORWARD
 #undef PARAM_LIST
\ No newline at end of file
@@ -1,7 +1,9 @@
 #include <array>
 #include <gtest/gtest.h>
 #include <numeric>
+#include <memory_resource>
 #include "../delegate/function.h"
+#include "../delegate/function_ref.h"
 
 #if defined _WIN32 || defined_WIN64
 
@@ -328,4 +330,619 @@ TEST(function, test_function_validate)
     ASSERT_EQ(f6.validate(), false);
     ASSERT_EQ(f6.try_invoke(1,2).has_value(), false);
 
+    //validated callable is invoked directly, validation does not go through the invoker
+    validate_res = true;
+    ASSERT_EQ(f6.try_invoke(1, 2).value(), 3);
+
+}
+
+namespace test_allocator
+{
+    struct counting_resource : std::pmr::memory_resource
+    {
+        size_t allocations = 0;
+        size_t deallocations = 0;
+
+        void* do_allocate(size_t bytes, size_t alignment) override
+        {
+            ++allocations;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override
+        {
+            ++deallocations;
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+        {
+            return this == &other;
+        }
+    };
+}
+
+TEST(function, test_function_allocator)
+{
+    using namespace auto_delegate;
+    using namespace test_allocator;
+
+    counting_resource resource;
+    std::pmr::polymorphic_allocator<std::byte> alloc(&resource);
+
+    struct large_buffer_t
+    {
+        uint64_t arr[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    } large;
+    double large_sum = std::accumulate(std::begin(large.arr), std::end(large.arr), 0.0);
+
+    {
+        //inline callable never touch the allocator
+        pmr::function<int(int, int)> f(std::allocator_arg, alloc, [](int a, int b) { return a + b; });
+        ASSERT_EQ(f(1, 2), 3);
+        ASSERT_EQ(resource.allocations, 0);
+
+        pmr::function<uint64_t(uint64_t)> f1(std::allocator_arg, alloc, [=](uint64_t a)
+        {
+            return std::accumulate(std::begin(large.arr), std::end(large.arr), a);
+        });
+        ASSERT_EQ(f1(123), large_sum + 123);
+        ASSERT_EQ(resource.allocations, 1);
+
+        //copy allocate from the same resource
+        auto f2 = f1;
+        ASSERT_EQ(f2(123), large_sum + 123);
+        ASSERT_EQ(resource.allocations, 2);
+
+        //move transfer the box
+        auto f3 = std::move(f1);
+        ASSERT_EQ(f3(123), large_sum + 123);
+        ASSERT_EQ(resource.allocations, 2);
+        ASSERT_FALSE(f1);
+
+        f2 = [](uint64_t a) { return a; };
+        ASSERT_EQ(resource.deallocations, 1);
+    }
+    ASSERT_EQ(resource.allocations, resource.deallocations);
+
+    {
+        function_v2::pmr::function<uint64_t(uint64_t)> f(std::allocator_arg, alloc, [=](uint64_t a)
+        {
+            return std::accumulate(std::begin(large.arr), std::end(large.arr), a);
+        });
+        ASSERT_EQ(f(123), large_sum + 123);
+        ASSERT_EQ(resource.allocations, 3);
+        auto f2 = f;
+        ASSERT_EQ(f2(123), large_sum + 123);
+        ASSERT_EQ(resource.allocations, 4);
+    }
+    ASSERT_EQ(resource.allocations, resource.deallocations);
+}
+
+TEST(function, test_unique_function)
+{
+    using namespace auto_delegate;
+
+    unique_function<int(int, int)> empty_f;
+    ASSERT_FALSE(empty_f);
+
+    //move only capture stay in the small buffer
+    auto p = std::make_unique<int>(10);
+    unique_function<int(int, int)> f = [p = std::move(p)](int a, int b) { return a + b + *p; };
+    ASSERT_EQ(f(1, 2), 13);
+
+    auto f2 = std::move(f);
+    ASSERT_EQ(f2(1, 2), 13);
+    ASSERT_FALSE(f);
+
+    struct large_buffer_t
+    {
+        uint64_t arr[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    } large;
+    double large_sum = std::accumulate(std::begin(large.arr), std::end(large.arr), 0.0);
+
+    //move only capture boxed
+    unique_function<uint64_t(uint64_t)> f3 = [=, p = std::make_unique<uint64_t>(1)](uint64_t a)
+    {
+        return std::accumulate(std::begin(large.arr), std::end(large.arr), a) + *p;
+    };
+    ASSERT_EQ(f3(123), large_sum + 124);
+
+    unique_function<uint64_t(uint64_t)> f4 = [](uint64_t a) { return a; };
+    f4.swap(f3);
+    ASSERT_EQ(f4(123), large_sum + 124);
+    ASSERT_EQ(f3(123), 123);
+
+    //take over a copyable function without boxing it again
+    function<uint64_t(uint64_t)> f5 = [=](uint64_t a)
+    {
+        return std::accumulate(std::begin(large.arr), std::end(large.arr), a);
+    };
+    unique_function<uint64_t(uint64_t)> f6 = std::move(f5);
+    ASSERT_FALSE(f5);
+    ASSERT_EQ(f6(123), large_sum + 123);
+
+    static_assert(not std::copy_constructible<unique_function<int(int, int)>>);
+    static_assert(sizeof(unique_function<int(int, int)>) == sizeof(function<int(int, int)>));
+}
+
+namespace test_function_ref
+{
+    struct counter
+    {
+        int value = 0;
+        int add(int a) { return value += a; }
+    };
+
+    int twice(int a) { return a * 2; }
+
+    int call(auto_delegate::function_ref<int(int)> f, int a) { return f(a); }
+}
+
+TEST(function, test_function_ref)
+{
+    using namespace auto_delegate;
+    using namespace test_function_ref;
+
+    //lambda is referenced, not copied
+    int offset = 1;
+    auto lambda = [&](int a) { return a + offset; };
+    ASSERT_EQ(call(lambda, 1), 2);
+    offset = 10;
+    ASSERT_EQ(call(lambda, 1), 11);
+
+    const auto const_lambda = [](int a) { return a - 1; };
+    ASSERT_EQ(call(const_lambda, 1), 0);
+
+    //function and unique_function reuse their own invoker
+    function<int(int)> f = [&](int a) { return a * offset; };
+    ASSERT_EQ(call(f, 2), 20);
+    auto p = std::make_unique<int>(3);
+    unique_function<int(int)> uf = [p = std::move(p)](int a) { return a * *p; };
+    ASSERT_EQ(call(uf, 2), 6);
+
+    struct large_buffer_t
+    {
+        uint64_t arr[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    } large;
+    function<int(int)> boxed = [=](int a) { return a + (int) large.arr[7]; };
+    ASSERT_EQ(call(boxed, 1), 9);
+
+    counter c;
+    delegate<int(int)> d;
+    d.bind<&counter::add>(&c);
+    ASSERT_EQ(call(d, 2), 2);
+    ASSERT_EQ(c.value, 2);
+
+    ASSERT_EQ(call(twice, 4), 8);
+    ASSERT_EQ(call(&twice, 4), 8);
+    ASSERT_EQ(call(func_tag<twice>{}, 5), 10);
+    ASSERT_EQ(call({&c, func_tag<&counter::add>{}}, 3), 5);
+
+    function_ref r = lambda;
+    static_assert(std::same_as<decltype(r), function_ref<int(int)>>);
+    function_ref<int(int)> r2 = r;
+    ASSERT_EQ(r2(1), 11);
+    static_assert(sizeof(function_ref<int(int)>) == 2 * sizeof(void*));
+}
+
+namespace test_relocate
+{
+    struct counted
+    {
+        static inline int move_count = 0;
+        static inline int destroy_count = 0;
+        int value;
+
+        explicit counted(int v) : value(v) {}
+        counted(const counted& o) : value(o.value) {}
+        counted(counted&& o) noexcept : value(o.value) { ++move_count; }
+        ~counted() { ++destroy_count; }
+
+        int operator()(int a) const { return a + value; }
+    };
+
+    struct relocatable_counted : counted
+    {
+        using counted::counted;
+        static constexpr bool is_trivially_relocatable = true;
+    };
+}
+
+TEST(function, test_trivially_relocatable)
+{
+    using namespace auto_delegate;
+    using namespace test_relocate;
+
+    static_assert(is_trivially_relocatable_v<std::unique_ptr<int>>);
+    static_assert(not is_trivially_relocatable_v<counted>);
+    static_assert(is_trivially_relocatable_v<relocatable_counted>);
+    //a boxed callable is memcpy relocated with the default and the pmr allocator
+    static_assert(is_trivially_relocatable_v<function_v1::internal::functor_box_wrapper<counted, std::allocator<std::byte>, int, int>>);
+    static_assert(is_trivially_relocatable_v<function_v2::internal::functor_box_wrapper<counted, std::allocator<std::byte>, int, int>>);
+    static_assert(is_trivially_relocatable_v<function_v1::internal::functor_box_wrapper<counted, std::pmr::polymorphic_allocator<std::byte>, int, int>>);
+
+    counted::move_count = 0;
+    {
+        std::vector<function<int(int)>> funcs;
+        for (int i = 0; i < 64; ++i)
+            funcs.emplace_back(relocatable_counted(i));
+        int construct_moves = counted::move_count;
+        ASSERT_EQ(construct_moves, 64);
+        funcs.front().swap(funcs.back());
+        funcs[1] = std::move(funcs[2]);
+        ASSERT_EQ(counted::move_count, construct_moves);
+        ASSERT_EQ(funcs.front()(0), 63);
+        ASSERT_EQ(funcs.back()(0), 0);
+        ASSERT_EQ(funcs[1](0), 2);
+        ASSERT_FALSE(funcs[2]);
+    }
+    counted::destroy_count = 0;
+    {
+        function<int(int)> f = relocatable_counted(1);
+        function<int(int)> f2 = std::move(f);
+        ASSERT_EQ(f2(1), 2);
+    }
+    //temporary, and the relocated callable once
+    ASSERT_EQ(counted::destroy_count, 2);
+
+    //not opted in, the move constructor is still used
+    counted::move_count = 0;
+    {
+        function<int(int)> f = counted(1);
+        function<int(int)> f2 = counted(2);
+        f.swap(f2);
+        ASSERT_EQ(f(0), 2);
+        ASSERT_EQ(f2(0), 1);
+        ASSERT_EQ(counted::move_count, 5);
+    }
+
+    //move only closure opted in by wrapping
+    auto p = std::make_unique<int>(10);
+    unique_function<int(int)> uf = make_trivially_relocatable([p = std::move(p)](int a) { return a + *p; });
+    unique_function<int(int)> uf2 = [](int a) { return a; };
+    uf.swap(uf2);
+    ASSERT_EQ(uf2(1), 11);
+    ASSERT_EQ(uf(1), 1);
+
+    function_v2::function<int(int)> v2f = relocatable_counted(3);
+    function_v2::function<int(int)> v2f2 = std::move(v2f);
+    ASSERT_EQ(v2f2(1), 4);
+}
+
+namespace test_telemetry
+{
+    //signature only used by this test so the counters start from zero
+    using signature_t = long(long, char);
+    using function_t = auto_delegate::function<signature_t>;
+
+    inline size_t overflow_count = 0;
+    inline size_t overflow_size = 0;
+
+    //built during static initialization, before the counters are first asked for
+    using static_function_t = auto_delegate::function<short(short)>;
+    static_function_t static_function = [offset = short(1)](short a) { return short(a + offset); };
+
+    void on_overflow(const auto_delegate::telemetry::overflow_info& info)
+    {
+        ++overflow_count;
+        overflow_size = info.callable_size;
+    }
+}
+
+TEST(function, test_function_telemetry)
+{
+    using namespace auto_delegate;
+    using namespace test_telemetry;
+
+    static_assert(telemetry::type_name<int>() == "int");
+
+    auto previous = telemetry::set_overflow_handler(on_overflow);
+
+    struct large_buffer_t
+    {
+        long arr[16]{};
+    } large;
+    {
+        function_t small = [](long a, char) { return a; };
+        function_t boxed = [large](long a, char) { return a + large.arr[0]; };
+        auto copy = boxed;
+        auto moved = std::move(copy);
+        ASSERT_EQ(moved(1, 'a'), 1);
+
+        //the const signature and a larger buffer are counted apart
+        function<long(long, char) const> const_boxed = [large](long a, char) { return a + large.arr[0]; };
+        auto const_copy = const_boxed;
+        function<signature_t, 256> fits = [large](long a, char) { return a + large.arr[0]; };
+        ASSERT_EQ(const_copy(1, 'a') + fits(1, 'a'), 2);
+    }
+
+    auto& counters = telemetry::counters_of<function_t>();
+    auto& const_counters = telemetry::counters_of<function<long(long, char) const>>();
+    auto& large_counters = telemetry::counters_of<function<signature_t, 256>>();
+    if constexpr (telemetry::enabled)
+    {
+        ASSERT_EQ(counters.inline_constructions, 1);
+        ASSERT_EQ(counters.boxed_constructions, 1);
+        ASSERT_EQ(counters.copies, 1);
+        ASSERT_EQ(counters.moves, 1);
+        ASSERT_EQ(const_counters.boxed_constructions, 1);
+        ASSERT_EQ(const_counters.copies, 1);
+        ASSERT_EQ(large_counters.inline_constructions, 1);
+        ASSERT_EQ(large_counters.boxed_constructions, 0);
+        ASSERT_EQ(overflow_count, 2);
+        ASSERT_EQ(overflow_size, sizeof(large_buffer_t));
+
+        bool found = false;
+        telemetry::for_each_signature([&](const telemetry::signature_counters& c)
+                                      {
+                                          if (&c == &counters) found = true;
+                                      });
+        ASSERT_TRUE(found);
+        ASSERT_EQ(counters.signature, telemetry::type_name<function_t>());
+        ASSERT_EQ(telemetry::counters_of<static_function_t>().inline_constructions, 1);
+    } else
+    {
+        //nothing is recorded when the telemetry is disabled
+        ASSERT_EQ(counters.inline_constructions + counters.boxed_constructions, 0);
+        ASSERT_EQ(overflow_count, 0);
+    }
+
+    telemetry::set_overflow_handler(previous);
+}
+
+namespace test_signature
+{
+    struct counter
+    {
+        int value = 0;
+        int add(int a) noexcept { return value += a; }
+        int get(int a) const noexcept { return value + a; }
+    };
+
+    int twice(int a) noexcept { return a * 2; }
+}
+
+TEST(function, test_noexcept_const_signature)
+{
+    using namespace auto_delegate;
+    using namespace test_signature;
+
+    auto nothrow_lambda = [](int a) noexcept { return a + 1; };
+    auto throwing_lambda = [](int a) { return a + 1; };
+    auto mutable_lambda = [n = 0](int a) mutable noexcept { return a + ++n; };
+
+    //noexcept signature only accepts targets that can not throw
+    function<int(int) noexcept> f = nothrow_lambda;
+    static_assert(noexcept(f(1)));
+    static_assert(not std::constructible_from<function<int(int) noexcept>, decltype(throwing_lambda)>);
+    ASSERT_EQ(f(1), 2);
+
+    unique_function<int(int) noexcept> uf = [p = std::make_unique<int>(2)](int a) noexcept { return a * *p; };
+    static_assert(noexcept(uf(1)));
+    ASSERT_EQ(uf(3), 6);
+
+    //const signature only accepts targets callable as const
+    function<int(int) const noexcept> cf = nothrow_lambda;
+    static_assert(noexcept(cf(1)));
+    static_assert(not std::constructible_from<function<int(int) const>, decltype(mutable_lambda)>);
+    static_assert(std::constructible_from<function<int(int)>, decltype(mutable_lambda)>);
+    ASSERT_EQ(cf(1), 2);
+    auto cf2 = cf;
+    cf = [](int a) noexcept { return a; };
+    ASSERT_EQ(cf(1), 1);
+    ASSERT_EQ(cf2(1), 2);
+
+    unique_function<int(int) const> ucf = [p = std::make_unique<int>(4)](int a) { return a + *p; };
+    ASSERT_EQ(ucf(1), 5);
+
+    counter c;
+    delegate<int(int) noexcept> d;
+    d.bind<&counter::add>(&c);
+    static_assert(noexcept(d(1)));
+    ASSERT_EQ(d(2), 2);
+
+    function_ref<int(int) noexcept> r = f;
+    static_assert(noexcept(r(1)));
+    ASSERT_EQ(r(1), 2);
+    function_ref<int(int) noexcept> rd = d;
+    ASSERT_EQ(rd(1), 3);
+    function_ref<int(int) noexcept> rs = func_tag<twice>{};
+    ASSERT_EQ(rs(2), 4);
+
+    function_ref<int(int) const noexcept> cr = cf2;
+    ASSERT_EQ(cr(1), 2);
+    const counter& cc = c;
+    function_ref<int(int) const noexcept> cm(&cc, func_tag<&counter::get>{});
+    ASSERT_EQ(cm(1), 4);
+    static_assert(not std::constructible_from<function_ref<int(int) const>, decltype(mutable_lambda)&>);
+}
+
+namespace test_constinit
+{
+    using namespace auto_delegate;
+
+    int add_one(int a) { return a + 1; }
+
+    struct counter
+    {
+        int value = 0;
+        int add(int a) { return value += a; }
+    };
+
+    inline counter global_counter;
+
+    //constant initialized, nothing runs at dynamic initialization
+    constinit delegate<int(int)> delegate_table[] = {
+            func_tag<add_one>{},
+            [](int a) { return a * 2; },
+            {&global_counter, func_tag<&counter::add>{}},
+    };
+
+    constinit function<int(int)> function_table[] = {
+            [](int a) { return a * 3; },
+            [](int a) { return a - 1; },
+    };
+
+    constinit function<int(int) const noexcept> const_function = [](int a) noexcept { return a; };
+
+    constinit unique_function<int(int)> unique_function_entry = [](int a) { return a + 2; };
+}
+
+TEST(function, test_constinit_table)
+{
+    using namespace test_constinit;
+
+    ASSERT_EQ(delegate_table[0](1), 2);
+    ASSERT_EQ(delegate_table[1](2), 4);
+    ASSERT_EQ(delegate_table[2](3), 3);
+    ASSERT_EQ(global_counter.value, 3);
+    //static and stateless entries have no object but are bound
+    for (auto& d: delegate_table)
+    {
+        ASSERT_TRUE(d.is_bound());
+        ASSERT_TRUE(bool(d));
+    }
+    auto unbound = delegate_table[0];
+    unbound.reset();
+    ASSERT_FALSE(unbound.is_bound());
+
+    ASSERT_EQ(function_table[0](2), 6);
+    ASSERT_EQ(function_table[1](2), 1);
+    ASSERT_EQ(const_function(5), 5);
+    ASSERT_EQ(unique_function_entry(1), 3);
+
+    //stateless entries copy and move like any trivial callable
+    auto copy = function_table[0];
+    ASSERT_EQ(copy(1), 3);
+    function_table[0].swap(function_table[1]);
+    ASSERT_EQ(function_table[0](2), 1);
+    ASSERT_EQ(function_table[1](2), 6);
+    function_table[0].swap(function_table[1]);
+
+    constexpr function<int(int)> empty;
+    ASSERT_FALSE(empty);
+}
+
+namespace test_shared_box
+{
+    struct large_callable
+    {
+        std::array<int, 64> table{};
+        inline static int copy_count = 0;
+        inline static int destroy_count = 0;
+
+        explicit large_callable(int value) { table.fill(value); }
+        large_callable(const large_callable& other) : table(other.table) { ++copy_count; }
+        ~large_callable() { ++destroy_count; }
+
+        int operator()(int a) const { return a + table[0]; }
+    };
+}
+
+TEST(function, test_shared_box)
+{
+    using namespace auto_delegate;
+    using namespace test_shared_box;
+
+    large_callable::copy_count = 0;
+    large_callable::destroy_count = 0;
+    {
+        large_callable callable(3);
+        function<int(int)> f(shared_box, callable);
+        ASSERT_EQ(large_callable::copy_count, 1);
+
+        //copies share the box, the callable is not copied again
+        std::vector<function<int(int)>> snapshot(8, f);
+        function<int(int)> moved = std::move(snapshot.back());
+        ASSERT_EQ(large_callable::copy_count, 1);
+        ASSERT_EQ(moved(1), 4);
+        ASSERT_EQ(snapshot.front().target<large_callable>(), snapshot[1].target<large_callable>());
+        ASSERT_EQ(f.target<large_callable>(), snapshot[1].target<large_callable>());
+        ASSERT_EQ(f.target<large_callable>()->table[0], 3);
+
+        f = [](int a) { return a; };
+        snapshot.clear();
+        ASSERT_EQ(large_callable::destroy_count, 0);
+        ASSERT_EQ(moved(1), 4);
+    }
+    //the local callable and the shared copy
+    ASSERT_EQ(large_callable::destroy_count, 2);
+
+    //the deep copy path copies on every copy
+    large_callable::copy_count = 0;
+    {
+        function<int(int)> f = large_callable(1);
+        auto copy = f;
+        ASSERT_EQ(copy(1), 2);
+        ASSERT_EQ(large_callable::copy_count, 2);
+        ASSERT_NE(f.target<large_callable>(), copy.target<large_callable>());
+    }
+
+    //the box is allocated from the resource of the function
+    std::array<std::byte, 1024> buffer;
+    std::pmr::monotonic_buffer_resource resource(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+    {
+        pmr::function<int(int) const> f(std::allocator_arg, &resource, shared_box, large_callable(2));
+        auto copy = f;
+        ASSERT_EQ(copy(1), 3);
+        auto p = reinterpret_cast<const std::byte*>(f.target<large_callable>());
+        ASSERT_TRUE(p >= buffer.data() and p < buffer.data() + buffer.size());
+    }
+}
+
+namespace test_type_id
+{
+    struct handler
+    {
+        int* calls;
+        int operator()(int a) const { return a + ++*calls; }
+    };
+
+    struct large_handler
+    {
+        std::array<int, 32> table{};
+        int operator()(int a) const { return a + table[0]; }
+    };
+}
+
+TEST(function, test_type_id_target)
+{
+    using namespace auto_delegate;
+    using namespace test_type_id;
+
+    ASSERT_NE(type_id<int>(), type_id<long>());
+    ASSERT_EQ(type_id<handler>(), type_id<handler>());
+
+    int calls = 0;
+    function<int(int)> f = handler{&calls};
+    ASSERT_EQ(f.target_type_id(), type_id<handler>());
+    ASSERT_EQ(f.target<handler>()->calls, &calls);
+    ASSERT_EQ(f.target<large_handler>(), nullptr);
+
+    //the expected handler is called directly, any other falls back to the stored invoker
+    ASSERT_EQ(f.invoke_as<handler>(1), 2);
+    ASSERT_EQ(f.invoke_as<large_handler>(1), 3);
+    ASSERT_EQ(calls, 2);
+
+    large_handler large;
+    large.table[0] = 5;
+    function<int(int) const> boxed = large;
+    ASSERT_EQ(boxed.target<large_handler>()->table[0], 5);
+    ASSERT_EQ(boxed.invoke_as<large_handler>(1), 6);
+    function<int(int)> shared(shared_box, large);
+    ASSERT_EQ(shared.target<large_handler>()->table[0], 5);
+    ASSERT_EQ(shared.invoke_as<large_handler>(1), 6);
+
+    auto stateless = [](int a) { return a * 2; };
+    unique_function<int(int)> uf = stateless;
+    ASSERT_EQ(uf.target_type_id(), type_id<decltype(stateless)>());
+    ASSERT_EQ(uf.invoke_as<decltype(stateless)>(3), 6);
+
+    function_v2::function<int(int)> v2f = handler{&calls};
+    ASSERT_EQ(v2f.target<handler>()->calls, &calls);
+
+    function<int(int)> empty;
+    ASSERT_EQ(empty.target_type_id(), type_id<void>());
+    ASSERT_EQ(empty.target<handler>(), nullptr);
 }
@@ -2,8 +2,13 @@
 // Created by Estelle on 2024-08-27.
 //
 #include "../delegate/multicast_function.h"
+#include "../delegate/concurrent_multicast_function.h"
+#include "../delegate/queued_multicast.h"
 #include "../reference_safe_delegate/reference_safe_delegate.h"
 #include <gtest/gtest.h>
+#include <memory_resource>
+#include <thread>
+#include <atomic>
 
 using namespace auto_delegate;
 using namespace auto_reference;
@@ -364,3 +369,914 @@ TEST(multicast_function, function_bind)
     delete b1;
     delete a;
 }
+
+TEST(multicast_function, pmr_allocator)
+{
+    std::array<std::byte, 4096> buffer{};
+    std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+
+    pmr::multicast_function<int(ARG_LIST)> a{std::pmr::polymorphic_allocator<std::byte>(&arena)};
+    ASSERT_EQ(a.get_allocator().resource(), &arena);
+
+    struct large_capture_t
+    {
+        uint64_t arr[16];
+    } large{};
+    auto b1 = new B("b1");
+
+    size_t hash = 0;
+    for (int i = 0; i < 8; ++i)
+    {
+        //capture overflow the small buffer, allocate from arena or throw bad_alloc by null_memory_resource
+        a.bind([=](ARG_LIST) { return b1->function(ARG_LIST_FORWARD) + int(large.arr[0]); });
+        hash += b1->hash();
+    }
+
+    invoke_hash = 0;
+    a.for_each_invoke(PARAM_LIST,
+                      [](auto&& results)
+                      {
+                          ASSERT_EQ(results, 0);
+                      });
+    ASSERT_EQ(invoke_hash, hash);
+
+    a.clear();
+    delete b1;
+}
+
+TEST(multicast_function, bind_function_object)
+{
+    int sum = 0;
+    function<void(int)> f = [&](int v) { sum += v; };
+    multicast_function<void(int)> a;
+    a.bind(f);
+    a += f;
+    a.bind(std::move(f));
+    a(1);
+    ASSERT_EQ(sum, 3);
+    ASSERT_EQ(a.size(), 3);
+}
+
+TEST(multicast_function, unique_function_element)
+{
+    multicast_function<int(ARG_LIST), unique_function<int(ARG_LIST)>> a;
+
+    auto b1 = std::make_unique<B>("b1");
+    auto b2 = std::make_unique<B>("b2");
+    size_t hash = b1->hash() + b2->hash();
+
+    //listener own the object
+    a.bind([b = std::move(b1)](ARG_LIST) { return b->function(ARG_LIST_FORWARD); });
+    a.bind([b = std::move(b2)](ARG_LIST) { return b->function(ARG_LIST_FORWARD); });
+
+    auto static_lambda_h = a.bind_unique_handled([](ARG_LIST)
+                                                 {
+                                                     invoke_hash += static_hash;
+                                                     return 0;
+                                                 });
+    hash += static_hash;
+
+    invoke_hash = 0;
+    a.for_each_invoke(PARAM_LIST,
+                      [](auto&& results)
+                      {
+                          ASSERT_EQ(results, 0);
+                      });
+    ASSERT_EQ(invoke_hash, hash);
+
+    static_lambda_h.unbind();
+    hash -= static_hash;
+
+    invoke_hash = 0;
+    a.for_each_invoke(PARAM_LIST, [](auto&&) {});
+    ASSERT_EQ(invoke_hash, hash);
+}
+
+TEST(multicast_function, noexcept_signature)
+{
+    multicast_function<void(ARG_LIST) noexcept> a;
+    static_assert(std::same_as<decltype(a)::function_t, function<void(ARG_LIST) noexcept>>);
+    static_assert(noexcept(a(PARAM_LIST)));
+
+    auto b1 = std::make_unique<B>("b1");
+    auto b2 = std::make_shared<B>("b2");
+    auto b3 = std::make_shared<B>("b3");
+    size_t hash = 0;
+
+    a.bind<&B::action>(b1.get());
+    hash += b1->hash();
+    a.bind_weak<&B::action>(b2);
+    hash += b2->hash();
+    a += weak_binder(b3) | bind_memfn<&B::action>;
+    hash += b3->hash();
+    auto h = a.bind_unique_handled([](ARG_LIST) noexcept { invoke_hash += static_hash; });
+    hash += static_hash;
+
+    //a listener that may throw can not be bound to a noexcept event
+    auto throwing = [](ARG_LIST) {};
+    static_assert(not decltype(a)::bindable<decltype(throwing)>);
+
+    invoke_hash = 0;
+    a(PARAM_LIST);
+    ASSERT_EQ(invoke_hash, hash);
+
+    h.unbind();
+    b2.reset();
+    invoke_hash = 0;
+    a(PARAM_LIST);
+    ASSERT_EQ(invoke_hash, b1->hash() + b3->hash());
+    ASSERT_EQ(a.size(), 2);
+}
+
+TEST(multicast_function, bind_inside_invoke)
+{
+    multicast_function<void(int)> a;
+    std::vector<int> calls;
+    int nested_calls = 0;
+
+    a.bind([&](int v)
+           {
+               calls.push_back(v);
+               //bound listeners are queued until the outermost invoke ends
+               if (v == 0)
+                   for (int i = 0; i < 64; ++i)
+                       a.bind([&, i](int v) { calls.push_back(100 + i); });
+           });
+    a.bind([&](int v)
+           {
+               //nested invoke calls every live listener once
+               if (v == 0 and nested_calls++ == 0) a(1);
+           });
+
+    a(0);
+    ASSERT_EQ(a.size(), 66);
+    //queued listeners are not called by the invoke that bound them, nor by the nested one
+    ASSERT_EQ(calls, (std::vector<int>{0, 1}));
+
+    calls.clear();
+    a(2);
+    ASSERT_EQ(calls.size(), 65);
+    ASSERT_EQ(calls.front(), 2);
+
+    //an expired listener met by a nested invoke is kept until the outermost invoke removes it
+    auto obj = std::make_shared<int>(0);
+    multicast_function<int(int)> b;
+    int b_nested = 0;
+    b.bind([&](int v)
+           {
+               if (v == 0 and b_nested++ == 0)
+               {
+                   obj.reset();
+                   int nested_sum = 0;
+                   b.for_each_invoke(1, [&](int r) { nested_sum += r; });
+                   //the expired listener is skipped, not removed
+                   EXPECT_EQ(nested_sum, 2);
+               }
+               return 1;
+           });
+    b.bind_weak(obj, [](int& o, int v) { return o + v; });
+    b.bind([](int v) { return v; });
+    int sum = 0;
+    b.for_each_invoke(0, [&](int r) { sum += r; });
+    ASSERT_EQ(sum, 1);
+    ASSERT_EQ(b.size(), 2);
+}
+
+TEST(multicast_function, throwing_listener)
+{
+    multicast_function<void(int)> a;
+    int calls = 0;
+    a.bind([&](int v)
+           {
+               ++calls;
+               if (v < 0) throw std::runtime_error("listener failed");
+           });
+    struct count_call
+    {
+        int* calls = nullptr;
+
+        void operator()(int) { ++*calls; }
+    };
+    auto h = a.bind_unique_handled(count_call{&calls});
+
+    ASSERT_THROW(a(-1), std::runtime_error);
+    ASSERT_THROW(a.for_each([](auto&& invoke) { invoke(-1); }), std::runtime_error);
+    //the iteration ended with the exception, binds are not queued anymore and unbind works
+    a.bind([&](int) { ++calls; });
+    ASSERT_EQ(a.size(), 3);
+    h.unbind();
+    calls = 0;
+    a(1);
+    ASSERT_EQ(calls, 2);
+
+    multicast_function<int(int)> b;
+    b.bind([](int v) { if (v < 0) throw std::runtime_error("listener failed"); return v; });
+    ASSERT_THROW(b.for_each_invoke(-1, [](int) {}), std::runtime_error);
+    ASSERT_THROW(b.combine(combiners::sum{}, -1), std::runtime_error);
+    b.bind([](int v) { return 2 * v; });
+    int sum = 0;
+    b.for_each_invoke(1, [&](int r) { sum += r; });
+    ASSERT_EQ(sum, 3);
+    ASSERT_EQ(b.combine(combiners::sum{}, 1), 3);
+}
+
+namespace test_parallel
+{
+    //tasks are claimed from a shared counter by a fixed number of threads
+    struct thread_executor
+    {
+        size_t thread_count;
+
+        void bulk_execute(size_t task_count, function_ref<void(size_t)> task) const
+        {
+            std::atomic<size_t> next = 0;
+            std::vector<std::thread> threads;
+            for (size_t t = 0; t < thread_count; ++t)
+                threads.emplace_back([&]
+                                     {
+                                         for (size_t i; (i = next.fetch_add(1)) < task_count;)
+                                             task(i);
+                                     });
+            for (auto& t: threads) t.join();
+        }
+    };
+}
+
+TEST(multicast_function, parallel_invoke)
+{
+    using namespace test_parallel;
+    static_assert(bulk_executor<thread_executor>);
+    static_assert(bulk_executor<inline_executor>);
+
+    constexpr int listener_count = 1000;
+    std::vector<std::atomic<int>> hits(listener_count);
+    std::vector<std::shared_ptr<int>> objects;
+
+    multicast_function<void(int)> a;
+    for (int i = 0; i < listener_count; ++i)
+    {
+        if (i % 3 == 0)
+        {
+            objects.push_back(std::make_shared<int>(i));
+            a.bind_weak(objects.back(), [&hits](int& o, int v) { hits[o] += v; });
+        } else
+            a.bind([&hits, i](int v) { hits[i] += v; });
+    }
+
+    a.parallel_invoke(thread_executor{4}, parallel_grain{16}, 1);
+    for (auto& h: hits) ASSERT_EQ(h, 1);
+
+    //expired listeners are removed concurrently, the others are still called once
+    objects.clear();
+    a.parallel_invoke(thread_executor{4}, parallel_grain{16}, 1);
+    for (int i = 0; i < listener_count; ++i)
+        ASSERT_EQ(hits[i], i % 3 == 0 ? 1 : 2);
+    ASSERT_EQ(a.size(), listener_count - (listener_count + 2) / 3);
+
+    a.parallel_invoke(inline_executor{}, 1);
+    for (int i = 0; i < listener_count; ++i)
+        ASSERT_EQ(hits[i], i % 3 == 0 ? 1 : 3);
+
+    //results are reduced through the given identity and reduction
+    multicast_function<int(int)> b;
+    auto value = std::make_shared<int>(1000);
+    for (int i = 0; i < listener_count; ++i)
+        b.bind([i](int v) { return i * v; });
+    b.bind_weak(value, [](int& o, int v) { return o * v; });
+    auto sum = [](int acc, int r) { return acc + r; };
+    ASSERT_EQ(b.parallel_invoke(thread_executor{3}, parallel_grain{7}, 0, sum, 2), listener_count * (listener_count - 1) + 2000);
+    value.reset();
+    ASSERT_EQ(b.parallel_invoke(thread_executor{3}, 0, sum, 2), listener_count * (listener_count - 1));
+    ASSERT_EQ(b.size(), listener_count);
+
+    //a throwing chunk still releases the deferred removals, the next invoke removes on call as usual
+    multicast_function<void(int)> e;
+    auto owner = std::make_shared<int>(1);
+    int weak_calls = 0;
+    e.bind([](int v) { if (v < 0) throw std::runtime_error("listener failed"); });
+    e.bind_weak(owner, [&](int&, int) { ++weak_calls; });
+    ASSERT_THROW(e.parallel_invoke(inline_executor{}, -1), std::runtime_error);
+    ASSERT_THROW(e.invoke_batch(std::vector<std::tuple<int>>{{-1}}), std::runtime_error);
+    owner.reset();
+    e(1);
+    ASSERT_EQ(e.size(), 1);
+    e.bind([&](int) { ++weak_calls; });
+    e(1);
+    ASSERT_EQ(weak_calls, 1);
+
+    struct counter
+    {
+        std::atomic<int> value = 0;
+        void add(int v) { value += v; }
+        int get(int v) { return value + v; }
+    };
+    std::vector<counter> counters(listener_count);
+    multicast_delegate<void(int)> c;
+    multicast_delegate<int(int)> d;
+    std::vector<multicast_delegate<void(int)>::delegate_handle_t> handles;
+    for (auto& o: counters)
+    {
+        handles.push_back(c.bind<&counter::add>(&o));
+        handles.push_back(d.bind<&counter::get>(&o));
+    }
+    c.parallel_invoke(thread_executor{4}, parallel_grain{10}, 2);
+    for (auto& o: counters) ASSERT_EQ(o.value, 2);
+    ASSERT_EQ(d.parallel_invoke(thread_executor{4}, 0, sum, 1), listener_count * 3);
+}
+
+TEST(multicast_function, invoke_batch)
+{
+    //takes the whole batch in one call, operator() is only used by single invokes
+    struct batch_listener
+    {
+        std::vector<int>* calls;
+        void operator()(int v) { calls->push_back(v); }
+        void invoke_batch(std::span<const std::tuple<int>> batch)
+        {
+            calls->push_back(-int(batch.size()));
+        }
+    };
+    const std::tuple<int> batch[] = {{1}, {2}, {3}};
+
+    multicast_function<void(int)> a;
+    std::vector<int> calls;
+    auto obj = std::make_shared<int>(10);
+    a.bind([&](int v) { calls.push_back(v); });
+    a.bind_weak(obj, [&](int& o, int v)
+    {
+        calls.push_back(o + v);
+        //expires inside the batch, removed once the batch is done
+        if (v == 2) obj.reset();
+    });
+    a.bind(batch_listener{&calls});
+
+    a.invoke_batch(batch);
+    //listener major order
+    ASSERT_EQ(calls, (std::vector<int>{1, 2, 3, 11, 12, -3}));
+    ASSERT_EQ(a.size(), 2);
+
+    calls.clear();
+    a.bind([&](int v)
+           {
+               //bound inside the batch, not called before the next invoke
+               if (v == 1) a.bind([&](int v) { calls.push_back(100 + v); });
+           });
+    a.invoke_batch(batch);
+    ASSERT_EQ(calls, (std::vector<int>{1, 2, 3, -3}));
+    ASSERT_EQ(a.size(), 4);
+    calls.clear();
+    a(0);
+    ASSERT_EQ(calls, (std::vector<int>{0, 0, 100}));
+
+    //a batch from inside a listener is invoked pack by pack, the outer batch keeps deferring its removals
+    multicast_function<void(int)> n;
+    std::vector<int> seen;
+    bool nested = false;
+    auto owner = std::make_shared<int>(100);
+    n.bind([&](int v)
+           {
+               seen.push_back(v);
+               if (not std::exchange(nested, true))
+                   n.invoke_batch(std::vector<std::tuple<int>>{{10}, {20}});
+           });
+    n.bind_weak(owner, [&](int& o, int v)
+    {
+        seen.push_back(o + v);
+        if (v == 2) owner.reset();
+    });
+    n.bind([&](int v) { seen.push_back(-v); });
+    n.invoke_batch(batch);
+    ASSERT_EQ(seen, (std::vector<int>{1, 10, 110, -10, 20, 120, -20, 2, 3, 101, 102, -1, -2, -3}));
+    ASSERT_EQ(n.size(), 2);
+
+    struct counter
+    {
+        std::vector<int> values;
+        void add(int v) { values.push_back(v); }
+    };
+    counter x, y;
+    multicast_delegate<void(int)> c;
+    auto hx = c.bind<&counter::add>(&x);
+    auto hy = c.bind<&counter::add>(&y);
+    c.invoke_batch(batch);
+    ASSERT_EQ(x.values, (std::vector<int>{1, 2, 3}));
+    ASSERT_EQ(y.values, (std::vector<int>{1, 2, 3}));
+}
+
+TEST(multicast_function, combiners)
+{
+    multicast_function<int(int)> a;
+    std::vector<int> calls;
+    auto obj = std::make_shared<int>(100);
+    for (int i = 0; i < 200; ++i)
+        a.bind([&calls, i](int v)
+               {
+                   calls.push_back(i);
+                   return i % 50 - v;
+               });
+    a.bind_weak(obj, [](int& o, int v) { return o + v; });
+
+    ASSERT_EQ(a.combine(combiners::sum{}, 0), 4 * 49 * 50 / 2 + 100);
+    ASSERT_EQ(a.combine(combiners::min{}, 1), -1);
+    ASSERT_EQ(a.combine(combiners::max{}, 1), 101);
+
+    //early exit, the remaining listeners are not called
+    calls.clear();
+    ASSERT_EQ(a.combine(combiners::first_valid{}, 0), 1);
+    ASSERT_EQ(calls, (std::vector<int>{0, 1}));
+    calls.clear();
+    ASSERT_TRUE(a.combine(combiners::any_of{[](int r) { return r > 10; }}, 0));
+    ASSERT_EQ(calls.size(), 12);
+    calls.clear();
+    ASSERT_FALSE(a.combine(combiners::all_of{[](int r) { return r < 3; }}, 0));
+    ASSERT_EQ(calls.size(), 4);
+
+    std::array<int, 3> out{};
+    calls.clear();
+    auto written = a.combine(combiners::collect_into{out}, 0);
+    ASSERT_EQ(written.size(), 3);
+    ASSERT_EQ(out, (std::array<int, 3>{0, 1, 2}));
+    ASSERT_EQ(calls.size(), 3);
+
+    //expired listeners are skipped and removed
+    obj.reset();
+    ASSERT_EQ(a.combine(combiners::max{}, 0), 49);
+    ASSERT_EQ(a.size(), 200);
+    std::vector<int> all(300);
+    ASSERT_EQ(a.combine(combiners::collect_into{all}, 0).size(), 200);
+
+    multicast_function<int(int)> empty;
+    ASSERT_EQ(empty.combine(combiners::min{}, 0), std::nullopt);
+    ASSERT_FALSE(empty.combine(combiners::any_of{}, 0));
+    ASSERT_TRUE(empty.combine(combiners::all_of{}, 0));
+    ASSERT_EQ(empty.combine(combiners::first_valid{}, 0), 0);
+
+    struct counter
+    {
+        int value;
+        int get(int v) { return value + v; }
+    };
+    std::vector<counter> counters{{1}, {2}, {3}};
+    multicast_delegate<int(int)> d;
+    std::vector<multicast_delegate<int(int)>::delegate_handle_t> handles;
+    for (auto& c: counters) handles.push_back(d.bind<&counter::get>(&c));
+    ASSERT_EQ(d.combine(combiners::sum{}, 1), 9);
+    ASSERT_EQ(d.combine(combiners::max{}, 0), 3);
+    ASSERT_TRUE(d.combine(combiners::any_of{[](int r) { return r == 2; }}, 0));
+}
+
+namespace test_sort
+{
+    template<int Group>
+    struct recorder
+    {
+        std::vector<int>* calls = nullptr;
+        int id = 0;
+
+        void operator()(int) { calls->push_back(Group * 100 + id); }
+    };
+}
+
+TEST(multicast_function, sort_by_invoker)
+{
+    using namespace test_sort;
+    multicast_function<void(int)> a;
+    std::vector<int> calls;
+    std::vector<std::optional<decltype(a.bind_unique_handled(recorder<0>{}))>> first_handles;
+    std::vector<std::optional<decltype(a.bind_unique_handled(recorder<1>{}))>> second_handles;
+    for (int i = 0; i < 12; ++i)
+    {
+        if (i % 3 == 0) first_handles.emplace_back(a.bind_unique_handled(recorder<0>{&calls, i}));
+        else if (i % 3 == 1) second_handles.emplace_back(a.bind_unique_handled(recorder<1>{&calls, i}));
+        else a.bind(recorder<2>{&calls, i});
+    }
+    a.sort_by_invoker();
+    a(0);
+    ASSERT_EQ(calls.size(), 12);
+    //listeners of the same type are adjacent and keep their relative order
+    for (int group = 0; group < 3; ++group)
+    {
+        for (int i = 1; i < 4; ++i)
+        {
+            ASSERT_EQ(calls[group * 4 + i] / 100, calls[group * 4] / 100);
+            ASSERT_LT(calls[group * 4 + i - 1], calls[group * 4 + i]);
+        }
+    }
+
+    //handles still refer to the listener they were bound with
+    first_handles[1].reset();
+    second_handles[2].reset();
+    calls.clear();
+    a(0);
+    ASSERT_EQ(calls.size(), 10);
+    ASSERT_EQ(std::count(calls.begin(), calls.end(), 3), 0);
+    ASSERT_EQ(std::count(calls.begin(), calls.end(), 107), 0);
+
+    struct counter
+    {
+        std::vector<int>* calls;
+        int id;
+        void first(int) { calls->push_back(id); }
+        void second(int) { calls->push_back(100 + id); }
+    };
+    std::vector<counter> counters;
+    for (int i = 0; i < 6; ++i) counters.push_back({&calls, i});
+    multicast_delegate<void(int)> d;
+    std::vector<std::optional<multicast_delegate<void(int)>::delegate_handle_t>> d_handles;
+    for (auto& c: counters)
+    {
+        if (c.id % 2) d_handles.emplace_back(d.bind<&counter::first>(&c));
+        else d_handles.emplace_back(d.bind<&counter::second>(&c));
+    }
+    d.sort_by_invoker();
+    d_handles[1].reset();
+    calls.clear();
+    d(0);
+    ASSERT_EQ(calls.size(), 5);
+    ASSERT_EQ(std::count(calls.begin(), calls.end(), 1), 0);
+    //unbinding moves the last listener into the hole, sorting again restores the groups
+    d.sort_by_invoker();
+    calls.clear();
+    d(0);
+    int group_changes = 0;
+    for (size_t i = 1; i < calls.size(); ++i)
+        group_changes += calls[i] / 100 != calls[i - 1] / 100;
+    ASSERT_EQ(group_changes, 1);
+}
+
+TEST(multicast_function, ordered_removal)
+{
+    using namespace test_sort;
+    multicast_ordered_function<void(int)> a;
+    std::vector<int> calls;
+    //nothing to compact in an empty container
+    a(0);
+    ASSERT_TRUE(a.empty());
+    std::vector<std::optional<decltype(a.bind_unique_handled(recorder<0>{}))>> handles;
+    std::vector<std::shared_ptr<int>> objects;
+    for (int i = 0; i < 16; ++i)
+    {
+        if (i % 4 == 3)
+        {
+            objects.push_back(std::make_shared<int>(i));
+            a.bind_weak(objects.back(), [&calls](int& o, int) { calls.push_back(100 + o); });
+        } else
+            handles.emplace_back(a.bind_unique_handled(recorder<0>{&calls, i}));
+    }
+    auto expected = [&]
+    {
+        std::vector<int> e;
+        for (int i = 0; i < 16; ++i)
+        {
+            if (i % 4 == 3)
+            {
+                if (objects[i / 4]) e.push_back(100 + i);
+            } else if (handles[i - i / 4]) e.push_back(i);
+        }
+        return e;
+    };
+
+    //removals keep the bind order of the remaining listeners
+    handles[0].reset();
+    handles[4].reset();
+    objects[1].reset();
+    a(0);
+    ASSERT_EQ(calls, expected());
+    ASSERT_EQ(a.size(), 13);
+
+    //enough tombstones trigger a compaction, handles follow their listener
+    for (int i: {1, 2, 7, 9}) handles[i].reset();
+    calls.clear();
+    a(0);
+    ASSERT_EQ(calls, expected());
+    ASSERT_EQ(a.size(), 9);
+    handles[10].reset();
+    objects[3].reset();
+    calls.clear();
+    a(0);
+    ASSERT_EQ(calls, expected());
+    ASSERT_EQ(a.size(), 7);
+
+    //binds inside an invoke are still appended in order
+    a.bind([&](int v) { if (v == 1) a.bind([&](int) { calls.push_back(1000); }); });
+    a(1);
+    calls.clear();
+    a(0);
+    ASSERT_EQ(calls.back(), 1000);
+    multicast_ordered_function<void(int)> cleared;
+    cleared.bind([](int) {});
+    cleared.clear();
+    cleared(0);
+    ASSERT_TRUE(cleared.empty());
+
+    struct counter
+    {
+        std::vector<int>* calls;
+        int id;
+        void add(int) { calls->push_back(id); }
+    };
+    std::vector<counter> counters;
+    for (int i = 0; i < 10; ++i) counters.push_back({&calls, i});
+    multicast_ordered_delegate<void(int)> d;
+    std::vector<std::optional<multicast_ordered_delegate<void(int)>::delegate_handle_t>> d_handles;
+    for (auto& c: counters) d_handles.emplace_back(d.bind<&counter::add>(&c));
+    for (int i: {0, 3, 4, 8}) d_handles[i].reset();
+    ASSERT_EQ(d.size(), 6);
+    calls.clear();
+    d(0);
+    ASSERT_EQ(calls, (std::vector<int>{1, 2, 5, 6, 7, 9}));
+    d_handles[9].reset();
+    d_handles[1].reset();
+    calls.clear();
+    d(0);
+    ASSERT_EQ(calls, (std::vector<int>{2, 5, 6, 7}));
+}
+
+namespace test_packed
+{
+    struct counting_resource : std::pmr::memory_resource
+    {
+        size_t allocations = 0;
+
+        void* do_allocate(size_t bytes, size_t alignment) override
+        {
+            ++allocations;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override
+        {
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+        {
+            return this == &other;
+        }
+    };
+}
+
+TEST(multicast_function, packed_storage)
+{
+    using namespace test_sort;
+    multicast_packed_function<void(int)> a;
+    std::vector<int> calls;
+    std::vector<std::optional<decltype(a.bind_unique_handled(recorder<0>{}))>> handles;
+    std::vector<std::shared_ptr<int>> objects;
+    for (int i = 0; i < 300; ++i)
+    {
+        if (i % 3 == 2)
+        {
+            objects.push_back(std::make_shared<int>(i));
+            a.bind_weak(objects.back(), [&calls](int& o, int) { calls.push_back(o); });
+        } else if (i % 3 == 1)
+            a.bind(recorder<1>{&calls, i});
+        else
+            handles.emplace_back(a.bind_unique_handled(recorder<0>{&calls, i}));
+    }
+    ASSERT_EQ(a.size(), 300);
+    //records are sized to their callable, far below one function each
+    ASSERT_LT(a.memory_size(), 300 * sizeof(function<void(int)>));
+
+    auto expected = [&]
+    {
+        std::vector<int> e;
+        for (int i = 0; i < 300; ++i)
+        {
+            if (i % 3 == 2)
+            {
+                if (objects[i / 3]) e.push_back(i);
+            } else if (i % 3 == 1)
+                e.push_back(100 + i);
+            else if (handles[i / 3])
+                e.push_back(i);
+        }
+        return e;
+    };
+    a(0);
+    ASSERT_EQ(calls, expected());
+
+    //removals keep the bind order, enough of them compact the arena
+    for (int i = 0; i < 100; i += 2) handles[i].reset();
+    for (int i = 0; i < 100; i += 3) objects[i].reset();
+    calls.clear();
+    a(0);
+    ASSERT_EQ(calls, expected());
+    ASSERT_EQ(a.size(), expected().size());
+    for (auto& h: handles) h.reset();
+    calls.clear();
+    a(0);
+    ASSERT_EQ(calls, expected());
+
+    //binds inside an invoke are appended after it
+    a.bind([&](int v) { if (v == 1) a.bind([&](int) { calls.push_back(-1); }); });
+    a(1);
+    calls.clear();
+    a(0);
+    ASSERT_EQ(calls.back(), -1);
+
+    std::tuple<int> batch[] = {{0}, {0}};
+    calls.clear();
+    a.invoke_batch(batch);
+    ASSERT_EQ(calls.size(), (expected().size() + 1) * 2);
+
+    multicast_packed_function<int(int)> b;
+    for (int i = 0; i < 10; ++i) b.bind([i](int v) { return i + v; });
+    ASSERT_EQ(b.combine(combiners::sum{}, 1), 55);
+    a.clear();
+    ASSERT_TRUE(a.empty());
+
+    //an empty arena is neither compacted nor reallocated by an invoke
+    test_packed::counting_resource resource;
+    multicast_function<void(int), pmr::function<void(int)>, packed_storage<>> e{std::pmr::polymorphic_allocator<std::byte>(&resource)};
+    for (int i = 0; i < 100; ++i) e(0);
+    ASSERT_EQ(resource.allocations, 0);
+    auto h0 = e.bind_unique_handled(recorder<0>{&calls, 0});
+    auto h1 = e.bind_unique_handled(recorder<0>{&calls, 1});
+    h0.unbind();
+    const size_t allocations = resource.allocations;
+    //the last listener leaves only tombstones, the arena is reset in place
+    h1.unbind();
+    for (int i = 0; i < 100; ++i) e(0);
+    ASSERT_EQ(resource.allocations, allocations);
+    ASSERT_TRUE(e.empty());
+    ASSERT_EQ(e.memory_size(), 0);
+}
+
+TEST(multicast_function, concurrent)
+{
+    concurrent_multicast_function<void(int)> a;
+    std::atomic<int64_t> sum = 0;
+    std::vector<concurrent_multicast_function<void(int)>::listener_id> ids;
+    for (int i = 0; i < 8; ++i)
+        ids.push_back(a.bind([&sum, i](int v) { sum += i * v; }));
+    a(1);
+    ASSERT_EQ(sum, 28);
+    ASSERT_TRUE(a.unbind(ids[7]));
+    ASSERT_FALSE(a.unbind(ids[7]));
+    sum = 0;
+    a(1);
+    ASSERT_EQ(sum, 21);
+
+    //readers see either snapshot around a rebind, never a freed one
+    std::atomic<bool> stop = false;
+    std::atomic<int64_t> invokes = 0;
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t)
+        readers.emplace_back([&]
+        {
+            while (!stop)
+            {
+                a(1);
+                ++invokes;
+            }
+        });
+    for (int i = 0; i < 2000; ++i)
+    {
+        auto id = a.bind([s = std::make_shared<int>(i)](int) { ASSERT_TRUE(s); });
+        ASSERT_TRUE(a.unbind(id));
+        if (i % 500 == 0) std::this_thread::yield();
+    }
+    while (invokes < 100) std::this_thread::yield();
+    stop = true;
+    for (auto& t: readers) t.join();
+    ASSERT_EQ(a.size(), 7);
+
+    //a listener may unbind itself and invoke the event again
+    concurrent_multicast_function<void(int)>::listener_id self = 0;
+    int calls = 0;
+    self = a.bind([&](int v)
+    {
+        ++calls;
+        a.unbind(self);
+        if (v) a(0);
+    });
+    a(1);
+    a(1);
+    ASSERT_EQ(calls, 1);
+
+    concurrent_multicast_function<int(int)> b;
+    for (int i = 0; i < 10; ++i) b.bind([i](int v) { return i + v; });
+    ASSERT_EQ(b.combine(combiners::sum{}, 1), 55);
+    b.clear();
+    ASSERT_TRUE(b.empty());
+}
+
+namespace test_expired
+{
+    struct listener
+    {
+        std::vector<int>* calls;
+        int id;
+
+        void on(int) { calls->push_back(id); }
+    };
+
+    template<typename Event>
+    void sweep()
+    {
+        Event a;
+        std::vector<int> calls;
+        std::vector<std::shared_ptr<listener>> owners;
+        for (int i = 0; i < 30; ++i)
+        {
+            owners.push_back(std::make_shared<listener>(&calls, i));
+            if (i % 3 == 0)
+                a.template bind_weak<&listener::on>(owners.back());
+            else if (i % 3 == 1)
+                a += weak_binder(owners.back()) | bind_memfn<&listener::on>;
+            else
+                a.bind([&calls, i](int) { calls.push_back(i); });
+        }
+        ASSERT_EQ(a.remove_expired(), 0);
+        for (int i = 0; i < 30; i += 2)
+            if (i % 3 != 2) owners[i].reset();
+        //weak listeners of both kinds are swept, plain ones never expire
+        ASSERT_EQ(a.remove_expired(), 10);
+        ASSERT_EQ(a.size(), 20);
+        a(0);
+        std::sort(calls.begin(), calls.end());
+        std::vector<int> expected;
+        for (int i = 0; i < 30; ++i)
+            if (i % 3 == 2 or i % 2) expected.push_back(i);
+        ASSERT_EQ(calls, expected);
+
+        //still removed on call when expired between sweeps
+        owners[1].reset();
+        calls.clear();
+        a(0);
+        ASSERT_EQ(calls.size(), 19);
+        ASSERT_EQ(a.size(), 19);
+        ASSERT_EQ(a.remove_expired(), 0);
+    }
+}
+
+TEST(multicast_function, remove_expired)
+{
+    using namespace test_expired;
+    sweep<multicast_function<void(int)>>();
+    sweep<multicast_ordered_function<void(int)>>();
+    sweep<multicast_packed_function<void(int)>>();
+    sweep<multicast_function<void(int), unique_function<void(int)>>>();
+}
+
+TEST(multicast_function, queued_multicast_function)
+{
+    struct recorder
+    {
+        std::vector<std::pair<int, int>>* log;
+        int id;
+
+        void on_event(int v) { log->emplace_back(id, v); }
+    };
+    std::vector<std::pair<int, int>> log;
+    recorder r0{&log, 0}, r1{&log, 1};
+
+    auto check = [&](auto& a)
+    {
+        log.clear();
+        a.enqueue(1);
+        a.enqueue(2);
+        ASSERT_EQ(a.queued(), 2);
+        ASSERT_TRUE(log.empty());
+        a.flush();
+        ASSERT_EQ(log, (std::vector<std::pair<int, int>>{{0, 1}, {1, 1}, {0, 2}, {1, 2}}));
+        ASSERT_EQ(a.queued(), 0);
+
+        log.clear();
+        a.enqueue(3);
+        a.enqueue(4);
+        a.flush_batch();
+        ASSERT_EQ(log, (std::vector<std::pair<int, int>>{{0, 3}, {0, 4}, {1, 3}, {1, 4}}));
+
+        log.clear();
+        a.enqueue(5);
+        a.discard();
+        a.flush();
+        ASSERT_TRUE(log.empty());
+    };
+    queued_multicast_function<void(int)> a;
+    a.bind<&recorder::on_event>(&r0);
+    a.bind<&recorder::on_event>(&r1);
+    check(a);
+
+    //events raised by a listener during the flush wait for the next one
+    queued_multicast_function<void(const std::string&)> b;
+    std::vector<std::string> seen;
+    b.bind([&](const std::string& s)
+    {
+        seen.push_back(s);
+        if (s.size() < 3) b.enqueue(s + "!");
+        b.flush();
+    });
+    std::string first = "a";
+    b.enqueue(first);
+    first = "changed";
+    b.flush();
+    ASSERT_EQ(seen, (std::vector<std::string>{"a"}));
+    ASSERT_EQ(b.queued(), 1);
+    b.flush();
+    b.flush();
+    ASSERT_EQ(seen, (std::vector<std::string>{"a", "a!", "a!!"}));
+    ASSERT_EQ(b.queued(), 0);
+}